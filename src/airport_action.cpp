@@ -27,6 +27,9 @@ namespace duckdb
     // This is the auth token.
     std::string auth_token;
 
+    // The name of the secret to use.
+    std::string secret_name;
+
     std::string action_name;
 
     // The parameters that will be passed to the action.
@@ -36,11 +39,13 @@ namespace duckdb
 
     explicit ActionBindData(std::string server_location,
                             std::string auth_token,
+                            std::string secret_name,
                             std::string action_name,
                             std::optional<std::string> parameter,
                             std::unordered_map<string, std::vector<string>> user_supplied_headers)
         : server_location(std::move(server_location)),
           auth_token(std::move(auth_token)),
+          secret_name(std::move(secret_name)),
           action_name(std::move(action_name)),
           parameter(std::move(parameter)),
           user_supplied_headers(std::move(user_supplied_headers))
@@ -69,7 +74,7 @@ namespace duckdb
     {
       const auto &bind_data = input.bind_data->Cast<ActionBindData>();
 
-      auto flight_client = AirportAPI::FlightClientForLocation(bind_data.server_location);
+      auto flight_client = AirportAPI::FlightClientForLocation(context, bind_data.server_location, bind_data.secret_name);
 
       return make_uniq<ActionGlobalState>(flight_client);
     }
@@ -129,6 +134,7 @@ namespace duckdb
 
     auto ret = make_uniq<ActionBindData>(server_location,
                                          auth_token,
+                                         secret_name,
                                          action_name,
                                          parameter,
                                          user_supplied_headers);
@@ -0,0 +1,317 @@
+#include "duckdb.hpp"
+#include "duckdb/planner/operator/logical_get.hpp"
+#include "duckdb/planner/expression/bound_columnref_expression.hpp"
+#include "duckdb/planner/expression/bound_comparison_expression.hpp"
+#include "duckdb/planner/expression/bound_conjunction_expression.hpp"
+#include "duckdb/planner/expression/bound_constant_expression.hpp"
+#include "duckdb/planner/expression/bound_operator_expression.hpp"
+#include "duckdb/planner/filter/constant_filter.hpp"
+#include "duckdb/planner/filter/null_filter.hpp"
+#include "duckdb/storage/statistics/base_statistics.hpp"
+#include "duckdb/storage/statistics/numeric_stats.hpp"
+#include "duckdb/storage/statistics/string_stats.hpp"
+#include "airport_endpoint_pruning.hpp"
+#include "airport_flight_stream.hpp"
+#include "msgpack.hpp"
+
+namespace duckdb
+{
+  static optional_idx AirportPruningColumnIndex(LogicalGet &get, const Expression &expr)
+  {
+    if (expr.GetExpressionClass() != ExpressionClass::BOUND_COLUMN_REF)
+    {
+      return optional_idx();
+    }
+    auto &column_ref = expr.Cast<BoundColumnRefExpression>();
+    auto &column_ids = get.GetColumnIds();
+    if (column_ref.binding.table_index != get.table_index || column_ref.binding.column_index >= column_ids.size())
+    {
+      return optional_idx();
+    }
+    auto &column_index = column_ids[column_ref.binding.column_index];
+    if (column_index.IsRowIdColumn())
+    {
+      return optional_idx();
+    }
+    return column_index.GetPrimaryIndex();
+  }
+
+  static void AirportAddPruningFilter(LogicalGet &get, const Expression &expr, TableFilterSet &result)
+  {
+    switch (expr.GetExpressionClass())
+    {
+    case ExpressionClass::BOUND_CONJUNCTION:
+    {
+      if (expr.GetExpressionType() != ExpressionType::CONJUNCTION_AND)
+      {
+        return;
+      }
+      for (auto &child : expr.Cast<BoundConjunctionExpression>().children)
+      {
+        AirportAddPruningFilter(get, *child, result);
+      }
+      return;
+    }
+    case ExpressionClass::BOUND_COMPARISON:
+    {
+      auto &comparison = expr.Cast<BoundComparisonExpression>();
+      auto comparison_type = comparison.GetExpressionType();
+      switch (comparison_type)
+      {
+      case ExpressionType::COMPARE_EQUAL:
+      case ExpressionType::COMPARE_LESSTHAN:
+      case ExpressionType::COMPARE_LESSTHANOREQUALTO:
+      case ExpressionType::COMPARE_GREATERTHAN:
+      case ExpressionType::COMPARE_GREATERTHANOREQUALTO:
+        break;
+      default:
+        return;
+      }
+
+      auto column_index = AirportPruningColumnIndex(get, *comparison.left);
+      const Expression *constant = comparison.right.get();
+      if (!column_index.IsValid())
+      {
+        column_index = AirportPruningColumnIndex(get, *comparison.right);
+        constant = comparison.left.get();
+        comparison_type = FlipComparisonExpression(comparison_type);
+      }
+      if (!column_index.IsValid() || constant->GetExpressionClass() != ExpressionClass::BOUND_CONSTANT)
+      {
+        return;
+      }
+      auto &value = constant->Cast<BoundConstantExpression>().value;
+      if (value.IsNull())
+      {
+        return;
+      }
+      result.PushFilter(ColumnIndex(column_index.GetIndex()), make_uniq<ConstantFilter>(comparison_type, value));
+      return;
+    }
+    case ExpressionClass::BOUND_OPERATOR:
+    {
+      auto &op = expr.Cast<BoundOperatorExpression>();
+      if (op.children.size() != 1)
+      {
+        return;
+      }
+      auto column_index = AirportPruningColumnIndex(get, *op.children[0]);
+      if (!column_index.IsValid())
+      {
+        return;
+      }
+      if (op.GetExpressionType() == ExpressionType::OPERATOR_IS_NULL)
+      {
+        result.PushFilter(ColumnIndex(column_index.GetIndex()), make_uniq<IsNullFilter>());
+      }
+      else if (op.GetExpressionType() == ExpressionType::OPERATOR_IS_NOT_NULL)
+      {
+        result.PushFilter(ColumnIndex(column_index.GetIndex()), make_uniq<IsNotNullFilter>());
+      }
+      return;
+    }
+    default:
+      return;
+    }
+  }
+
+  unique_ptr<TableFilterSet> AirportEndpointPruningFilters(LogicalGet &get, const vector<unique_ptr<Expression>> &filters)
+  {
+    auto result = make_uniq<TableFilterSet>();
+    for (auto &filter : filters)
+    {
+      AirportAddPruningFilter(get, *filter, *result);
+    }
+    if (result->filters.empty())
+    {
+      return nullptr;
+    }
+    return result;
+  }
+
+  static bool AirportMsgpackToValue(const msgpack::object &obj, Value &result)
+  {
+    switch (obj.type)
+    {
+    case msgpack::type::BOOLEAN:
+      result = Value::BOOLEAN(obj.via.boolean);
+      return true;
+    case msgpack::type::POSITIVE_INTEGER:
+      result = Value::UBIGINT(obj.via.u64);
+      return true;
+    case msgpack::type::NEGATIVE_INTEGER:
+      result = Value::BIGINT(obj.via.i64);
+      return true;
+    case msgpack::type::FLOAT32:
+    case msgpack::type::FLOAT64:
+      result = Value::DOUBLE(obj.via.f64);
+      return true;
+    case msgpack::type::STR:
+      result = Value(string(obj.via.str.ptr, obj.via.str.size));
+      return true;
+    default:
+      return false;
+    }
+  }
+
+  static const msgpack::object *AirportMsgpackMapGet(const msgpack::object &map, const string &key)
+  {
+    if (map.type != msgpack::type::MAP)
+    {
+      return nullptr;
+    }
+    for (uint32_t i = 0; i < map.via.map.size; i++)
+    {
+      auto &entry = map.via.map.ptr[i];
+      if (entry.key.type == msgpack::type::STR &&
+          key.compare(0, string::npos, entry.key.via.str.ptr, entry.key.via.str.size) == 0)
+      {
+        return &entry.val;
+      }
+    }
+    return nullptr;
+  }
+
+  // Build the statistics of a column of an endpoint, returns false if not
+  // enough is known about the column for it to be used for pruning.
+  static bool AirportEndpointColumnStatistics(const msgpack::object &column_stats,
+                                              const LogicalType &type,
+                                              BaseStatistics &result)
+  {
+    int64_t null_count = -1;
+    int64_t row_count = -1;
+    if (auto null_count_obj = AirportMsgpackMapGet(column_stats, "null_count"))
+    {
+      if (null_count_obj->type != msgpack::type::POSITIVE_INTEGER)
+      {
+        return false;
+      }
+      null_count = (int64_t)null_count_obj->via.u64;
+    }
+    if (auto row_count_obj = AirportMsgpackMapGet(column_stats, "row_count"))
+    {
+      if (row_count_obj->type != msgpack::type::POSITIVE_INTEGER)
+      {
+        return false;
+      }
+      row_count = (int64_t)row_count_obj->via.u64;
+    }
+
+    auto min_obj = AirportMsgpackMapGet(column_stats, "min");
+    auto max_obj = AirportMsgpackMapGet(column_stats, "max");
+
+    const bool all_null = null_count >= 0 && row_count >= 0 && null_count == row_count;
+
+    if (null_count != 0)
+    {
+      result.SetHasNull();
+    }
+
+    if (all_null)
+    {
+      // No values to compare against, so only the null filters matter.
+      return true;
+    }
+
+    result.SetHasNoNull();
+
+    if (!min_obj || !max_obj)
+    {
+      return false;
+    }
+
+    Value min_value;
+    Value max_value;
+    if (!AirportMsgpackToValue(*min_obj, min_value) || !AirportMsgpackToValue(*max_obj, max_value))
+    {
+      return false;
+    }
+    if (!min_value.DefaultTryCastAs(type, true) || !max_value.DefaultTryCastAs(type, true))
+    {
+      return false;
+    }
+
+    switch (result.GetStatsType())
+    {
+    case StatisticsType::NUMERIC_STATS:
+      NumericStats::SetMin(result, min_value);
+      NumericStats::SetMax(result, max_value);
+      return true;
+    case StatisticsType::STRING_STATS:
+      StringStats::Update(result, StringValue::Get(min_value));
+      StringStats::Update(result, StringValue::Get(max_value));
+      return true;
+    default:
+      return false;
+    }
+  }
+
+  static bool AirportEndpointCanMatch(ClientContext &context,
+                                      const AirportTakeFlightBindData &bind_data,
+                                      const TableFilterSet &filters,
+                                      const string &app_metadata)
+  {
+    try
+    {
+      msgpack::object_handle oh = msgpack::unpack(app_metadata.data(), app_metadata.size());
+      auto all_column_stats = AirportMsgpackMapGet(oh.get(), "column_statistics");
+      if (!all_column_stats)
+      {
+        return true;
+      }
+
+      for (auto &entry : filters.filters)
+      {
+        const auto column_index = entry.first;
+        if (column_index >= bind_data.return_names().size())
+        {
+          continue;
+        }
+        auto column_stats = AirportMsgpackMapGet(*all_column_stats, bind_data.return_names()[column_index]);
+        if (!column_stats)
+        {
+          continue;
+        }
+
+        auto &type = bind_data.return_types()[column_index];
+        auto stats = BaseStatistics::CreateEmpty(type);
+        if (!AirportEndpointColumnStatistics(*column_stats, type, stats))
+        {
+          continue;
+        }
+        if (entry.second->CheckStatistics(stats) == FilterPropagateResult::FILTER_ALWAYS_FALSE)
+        {
+          return false;
+        }
+      }
+    }
+    catch (const std::exception &)
+    {
+      // The app_metadata is in some other format, so nothing is known about
+      // the endpoint.
+      return true;
+    }
+    return true;
+  }
+
+  idx_t AirportPruneEndpoints(ClientContext &context,
+                              const AirportTakeFlightBindData &bind_data,
+                              vector<arrow::flight::FlightEndpoint> &endpoints)
+  {
+    auto filters = bind_data.endpoint_pruning_filters.get();
+    if (!filters || filters->filters.empty())
+    {
+      return 0;
+    }
+
+    const auto original_count = endpoints.size();
+    endpoints.erase(std::remove_if(endpoints.begin(), endpoints.end(),
+                                   [&](const arrow::flight::FlightEndpoint &endpoint)
+                                   {
+                                     return !endpoint.app_metadata.empty() &&
+                                            !AirportEndpointCanMatch(context, bind_data, *filters, endpoint.app_metadata);
+                                   }),
+                    endpoints.end());
+    return original_count - endpoints.size();
+  }
+}
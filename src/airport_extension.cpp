@@ -12,6 +12,10 @@
 #include "airport_secrets.hpp"
 #include "airport_optimizer.hpp"
 #include "airport_scalar_function.hpp"
+#include "airport_settings.hpp"
+#include "airport_memory_pool.hpp"
+#include "airport_flight_client_pool.hpp"
+#include "airport_scalar_function_cache.hpp"
 #include <curl/curl.h>
 
 namespace duckdb
@@ -33,10 +37,15 @@ namespace duckdb
         {
             auto lower_name = StringUtil::Lower(named_param.first);
 
+            AirportFlightClientOptions client_options;
             if (lower_name == "auth_token")
             {
                 result->secret_map["auth_token"] = named_param.second.ToString();
             }
+            else if (client_options.Set(lower_name, named_param.second))
+            {
+                result->secret_map[lower_name] = named_param.second;
+            }
             else
             {
                 throw InternalException("Unknown named parameter passed to CreateAirportSecretFunction: " + lower_name);
@@ -52,6 +61,10 @@ namespace duckdb
     static void AirportSetSecretParameters(CreateSecretFunction &function)
     {
         function.named_parameters["auth_token"] = LogicalType::VARCHAR;
+        for (auto &name : AirportFlightClientOptions::Names())
+        {
+            function.named_parameters[name] = LogicalType::BIGINT;
+        }
     }
 
     static unique_ptr<Catalog> AirportCatalogAttach(StorageExtensionInfo *storage_info, ClientContext &context,
@@ -61,6 +74,7 @@ namespace duckdb
         string secret_name;
         string auth_token;
         string location;
+        AirportFlightClientOptions attach_client_options;
 
         // check if we have a secret provided
         for (auto &entry : info.options)
@@ -82,6 +96,10 @@ namespace duckdb
             {
                 location = entry.second.ToString();
             }
+            else if (attach_client_options.Set(lower_name, entry.second))
+            {
+                continue;
+            }
             else
             {
                 throw BinderException("Unrecognized option for Airport ATTACH: %s", entry.first);
@@ -95,7 +113,16 @@ namespace duckdb
             throw BinderException("No location provided for Airport ATTACH.");
         }
 
-        return make_uniq<AirportCatalog>(db, info.path, access_mode, AirportAttachParameters(location, auth_token, secret_name, ""));
+        // The transport options of the ATTACH take precedence over the ones
+        // of the secret, which take precedence over the settings. They are
+        // only used by the clients of this database.
+        auto client_options = AirportFlightClientOptionsFromSettings(context);
+        AirportFlightClientOptionsFromSecret(context, location, secret_name, client_options);
+        client_options.Merge(attach_client_options);
+
+        return make_uniq<AirportCatalog>(db, info.path, access_mode, AirportAttachParameters(location, auth_token, secret_name, "",
+                                                                                                      AirportFlightChannelsPerLocation(context),
+                                                                                                      client_options));
     }
 
     static unique_ptr<TransactionManager> CreateTransactionManager(StorageExtensionInfo *storage_info, AttachedDatabase &db,
@@ -186,6 +213,10 @@ namespace duckdb
         AirportAddTakeFlightFunction(loader);
         AirportAddUserAgentFunction(loader);
         AirportAddActionFlightFunction(loader);
+        AirportAddSettings(loader);
+        AirportAddMemoryUsageFunction(loader);
+        AirportAddFlightClientPoolsFunction(loader);
+        AirportAddScalarFunctionCacheFunction(loader);
 
         // So to create a new macro for airport_list_databases
         // that calls airport_take_flight with a fixed flight descriptor
@@ -0,0 +1,334 @@
+#include "duckdb.hpp"
+#include "duckdb/main/config.hpp"
+#include "airport_extension.hpp"
+#include "airport_flight_client_pool.hpp"
+#include "airport_macros.hpp"
+#include "airport_flight_exception.hpp"
+#include "airport_settings.hpp"
+
+#include <mutex>
+
+namespace flight = arrow::flight;
+
+namespace duckdb
+{
+  idx_t AirportFlightChannelsPerLocation(ClientContext &context)
+  {
+    return MaxValue<idx_t>(AirportGetUBigIntSetting(context, "airport_flight_channels_per_location", AIRPORT_DEFAULT_FLIGHT_CHANNELS_PER_LOCATION), 1);
+  }
+
+  void AirportCheckFlightChannelsPerLocation(ClientContext &context, SetScope scope, Value &parameter)
+  {
+    if (!parameter.IsNull() && parameter.GetValue<uint64_t>() == 0)
+    {
+      throw InvalidInputException("airport_flight_channels_per_location must be at least 1");
+    }
+  }
+
+  using airport_flight_client_option_member_t = int64_t AirportFlightClientOptions::*;
+
+  static const vector<std::pair<string, airport_flight_client_option_member_t>> &AirportFlightClientOptionMembers()
+  {
+    static const vector<std::pair<string, airport_flight_client_option_member_t>> members = {
+        {"grpc_max_receive_message_size", &AirportFlightClientOptions::grpc_max_receive_message_size},
+        {"grpc_max_send_message_size", &AirportFlightClientOptions::grpc_max_send_message_size},
+        {"grpc_initial_window_size", &AirportFlightClientOptions::grpc_initial_window_size},
+        {"grpc_keepalive_time_ms", &AirportFlightClientOptions::grpc_keepalive_time_ms},
+        {"grpc_keepalive_timeout_ms", &AirportFlightClientOptions::grpc_keepalive_timeout_ms},
+        {"grpc_enable_http_proxy", &AirportFlightClientOptions::grpc_enable_http_proxy},
+        {"grpc_write_size_limit_bytes", &AirportFlightClientOptions::grpc_write_size_limit_bytes},
+    };
+    return members;
+  }
+
+  const vector<string> &AirportFlightClientOptions::Names()
+  {
+    static const vector<string> names = []()
+    {
+      vector<string> result;
+      for (auto &member : AirportFlightClientOptionMembers())
+      {
+        result.push_back(member.first);
+      }
+      return result;
+    }();
+    return names;
+  }
+
+  bool AirportFlightClientOptions::Set(const string &name, const Value &value)
+  {
+    auto lower_name = StringUtil::Lower(name);
+    for (auto &member : AirportFlightClientOptionMembers())
+    {
+      if (member.first == lower_name)
+      {
+        if (value.IsNull())
+        {
+          this->*member.second = -1;
+        }
+        else if (value.type().id() == LogicalTypeId::BOOLEAN)
+        {
+          this->*member.second = BooleanValue::Get(value) ? 1 : 0;
+        }
+        else
+        {
+          this->*member.second = value.DefaultCastAs(LogicalType::BIGINT).GetValue<int64_t>();
+        }
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void AirportFlightClientOptions::Merge(const AirportFlightClientOptions &other)
+  {
+    for (auto &member : AirportFlightClientOptionMembers())
+    {
+      if (other.*member.second != -1)
+      {
+        this->*member.second = other.*member.second;
+      }
+    }
+  }
+
+  void AirportFlightClientOptions::Apply(flight::FlightClientOptions &options) const
+  {
+    auto add_int_option = [&options](const string &name, const int64_t value)
+    {
+      if (value != -1)
+      {
+        options.generic_options.emplace_back(name, (int)MinValue<int64_t>(value, NumericLimits<int32_t>::Maximum()));
+      }
+    };
+
+    add_int_option("grpc.max_receive_message_length", grpc_max_receive_message_size);
+    add_int_option("grpc.max_send_message_length", grpc_max_send_message_size);
+    add_int_option("grpc.keepalive_time_ms", grpc_keepalive_time_ms);
+    add_int_option("grpc.keepalive_timeout_ms", grpc_keepalive_timeout_ms);
+    add_int_option("grpc.enable_http_proxy", grpc_enable_http_proxy);
+    if (grpc_initial_window_size != -1)
+    {
+      // Probing would change the window again, so keep it fixed.
+      add_int_option("grpc.http2.lookahead_bytes", grpc_initial_window_size);
+      add_int_option("grpc.http2.bdp_probe", 0);
+    }
+    if (grpc_write_size_limit_bytes != -1)
+    {
+      options.write_size_limit_bytes = grpc_write_size_limit_bytes;
+    }
+  }
+
+  bool AirportFlightClientOptions::operator==(const AirportFlightClientOptions &other) const
+  {
+    for (auto &member : AirportFlightClientOptionMembers())
+    {
+      if (this->*member.second != other.*member.second)
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  AirportFlightClientOptions AirportFlightClientOptionsFromSettings(ClientContext &context)
+  {
+    AirportFlightClientOptions result;
+    for (auto &member : AirportFlightClientOptionMembers())
+    {
+      Value value;
+      if (context.TryGetCurrentSetting("airport_" + member.first, value) && !value.IsNull())
+      {
+        result.*member.second = value.GetValue<int64_t>();
+      }
+    }
+    return result;
+  }
+
+  static void AirportAddFlightClientSetting(DBConfig &config, const string &name, const string &description)
+  {
+    config.AddExtensionOption("airport_" + name,
+                              description + " (-1 uses the default)",
+                              LogicalType::BIGINT,
+                              Value::BIGINT(-1));
+  }
+
+  void AirportAddFlightClientSettings(DBConfig &config)
+  {
+    AirportAddFlightClientSetting(config, "grpc_max_receive_message_size", "The largest gRPC message Flight clients will receive");
+    AirportAddFlightClientSetting(config, "grpc_max_send_message_size", "The largest gRPC message Flight clients will send");
+    AirportAddFlightClientSetting(config, "grpc_initial_window_size", "The HTTP/2 flow control window of Flight clients in bytes");
+    AirportAddFlightClientSetting(config, "grpc_keepalive_time_ms", "How often Flight clients send HTTP/2 keepalive pings");
+    AirportAddFlightClientSetting(config, "grpc_keepalive_timeout_ms", "How long Flight clients wait for a keepalive ping to be acknowledged");
+    AirportAddFlightClientSetting(config, "grpc_enable_http_proxy", "Set to 0 to stop Flight clients from using the http_proxy environment variables");
+    AirportAddFlightClientSetting(config, "grpc_write_size_limit_bytes", "The size above which Flight clients split record batches that they write");
+  }
+
+  AirportFlightClientPool::AirportFlightClientPool(const string &location,
+                                                   const idx_t channel_count,
+                                                   const AirportFlightClientOptions &client_options)
+      : location_(location), options_(client_options)
+  {
+    AIRPORT_ASSIGN_OR_RAISE_LOCATION(auto parsed_location,
+                                     flight::Location::Parse(location), location, "");
+
+    auto options = flight::FlightClientOptions::Defaults();
+    // gRPC shares connections between channels that have the same arguments,
+    // give each channel its own so the pool really has separate connections.
+    options.generic_options.emplace_back("grpc.use_local_subchannel_pool", 1);
+    client_options.Apply(options);
+
+    for (idx_t i = 0; i < channel_count; i++)
+    {
+      auto pooled = std::make_shared<PooledClient>();
+      AIRPORT_ASSIGN_OR_RAISE_LOCATION(pooled->client,
+                                       flight::FlightClient::Connect(parsed_location, options),
+                                       location, "");
+      clients_.push_back(std::move(pooled));
+    }
+  }
+
+  std::shared_ptr<flight::FlightClient> AirportFlightClientPool::Acquire()
+  {
+    total_requests_.fetch_add(1, std::memory_order_relaxed);
+
+    // Start at the next client in turn, but prefer a client with fewer
+    // users if there is one.
+    const auto start = next_client_.fetch_add(1, std::memory_order_relaxed);
+    auto selected = clients_[start % clients_.size()];
+    for (idx_t i = 1; i < clients_.size(); i++)
+    {
+      auto &candidate = clients_[(start + i) % clients_.size()];
+      if (candidate->in_use.load(std::memory_order_relaxed) < selected->in_use.load(std::memory_order_relaxed))
+      {
+        selected = candidate;
+      }
+    }
+
+    selected->in_use.fetch_add(1, std::memory_order_relaxed);
+
+    // The returned pointer keeps the pooled client alive and marks it as
+    // no longer being used when it is released.
+    auto client = selected->client.get();
+    return std::shared_ptr<flight::FlightClient>(client, [selected](flight::FlightClient *)
+                                                 { selected->in_use.fetch_sub(1, std::memory_order_relaxed); });
+  }
+
+  idx_t AirportFlightClientPool::clients_in_use() const
+  {
+    idx_t total = 0;
+    for (auto &pooled : clients_)
+    {
+      total += pooled->in_use.load(std::memory_order_relaxed);
+    }
+    return total;
+  }
+
+  // The pools of each location, a location has more than one pool when
+  // its clients are used with different options or channel counts.
+  using airport_flight_client_pool_map_t = std::unordered_map<string, vector<shared_ptr<AirportFlightClientPool>>>;
+
+  // Readers load the current map without a lock, writers copy it, add to
+  // the copy and then publish it. A map that was replaced is freed once the
+  // last reader that loaded it lets go of it.
+  static std::shared_ptr<const airport_flight_client_pool_map_t> airport_flight_client_pools =
+      std::make_shared<const airport_flight_client_pool_map_t>();
+  static std::mutex airport_flight_client_pools_write_lock;
+
+  static shared_ptr<AirportFlightClientPool> AirportFindFlightClientPool(const airport_flight_client_pool_map_t &pools,
+                                                                        const string &location,
+                                                                        const idx_t channel_count,
+                                                                        const AirportFlightClientOptions &options)
+  {
+    auto it = pools.find(location);
+    if (it == pools.end())
+    {
+      return nullptr;
+    }
+    for (auto &pool : it->second)
+    {
+      if (pool->channel_count() == channel_count && pool->options() == options)
+      {
+        return pool;
+      }
+    }
+    return nullptr;
+  }
+
+  shared_ptr<AirportFlightClientPool> AirportFlightClientPoolForLocation(const string &location,
+                                                                        const idx_t channel_count,
+                                                                        const AirportFlightClientOptions &options)
+  {
+    auto existing = AirportFindFlightClientPool(*std::atomic_load(&airport_flight_client_pools),
+                                                location, channel_count, options);
+    if (existing)
+    {
+      return existing;
+    }
+
+    std::lock_guard<std::mutex> lock(airport_flight_client_pools_write_lock);
+    auto pools = std::atomic_load(&airport_flight_client_pools);
+    existing = AirportFindFlightClientPool(*pools, location, channel_count, options);
+    if (existing)
+    {
+      return existing;
+    }
+
+    auto pool = make_shared_ptr<AirportFlightClientPool>(location, channel_count, options);
+    auto updated = std::make_shared<airport_flight_client_pool_map_t>(*pools);
+    (*updated)[location].push_back(pool);
+    std::atomic_store(&airport_flight_client_pools, std::shared_ptr<const airport_flight_client_pool_map_t>(std::move(updated)));
+    return pool;
+  }
+
+  struct AirportFlightClientPoolsFunctionData : public TableFunctionData
+  {
+    vector<shared_ptr<AirportFlightClientPool>> pools;
+    idx_t offset = 0;
+  };
+
+  static unique_ptr<FunctionData> AirportFlightClientPoolsBind(ClientContext &context, TableFunctionBindInput &input,
+                                                               vector<LogicalType> &return_types, vector<string> &names)
+  {
+    names.emplace_back("location");
+    return_types.emplace_back(LogicalType::VARCHAR);
+    names.emplace_back("channels");
+    return_types.emplace_back(LogicalType::BIGINT);
+    names.emplace_back("clients_in_use");
+    return_types.emplace_back(LogicalType::BIGINT);
+    names.emplace_back("total_requests");
+    return_types.emplace_back(LogicalType::BIGINT);
+
+    auto result = make_uniq<AirportFlightClientPoolsFunctionData>();
+    auto pools = std::atomic_load(&airport_flight_client_pools);
+    for (auto &entry : *pools)
+    {
+      for (auto &pool : entry.second)
+      {
+        result->pools.push_back(pool);
+      }
+    }
+    return result;
+  }
+
+  static void AirportFlightClientPoolsFunction(ClientContext &context, TableFunctionInput &data_p, DataChunk &output)
+  {
+    auto &data = data_p.bind_data->CastNoConst<AirportFlightClientPoolsFunctionData>();
+    idx_t count = 0;
+    while (data.offset < data.pools.size() && count < STANDARD_VECTOR_SIZE)
+    {
+      auto &pool = *data.pools[data.offset++];
+      output.SetValue(0, count, Value(pool.location()));
+      output.SetValue(1, count, Value::BIGINT(pool.channel_count()));
+      output.SetValue(2, count, Value::BIGINT(pool.clients_in_use()));
+      output.SetValue(3, count, Value::BIGINT(pool.total_requests()));
+      count++;
+    }
+    output.SetCardinality(count);
+  }
+
+  void AirportAddFlightClientPoolsFunction(ExtensionLoader &loader)
+  {
+    TableFunction pools_function("airport_flight_client_pools", {}, AirportFlightClientPoolsFunction, AirportFlightClientPoolsBind);
+    loader.RegisterFunction(pools_function);
+  }
+}
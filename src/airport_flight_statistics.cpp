@@ -198,7 +198,7 @@ namespace duckdb
     params.column_name = schema->name;
     params.type = duck_type.ToString();
 
-    auto flight_client = AirportAPI::FlightClientForLocation(server_location);
+    auto flight_client = AirportTakeFlightClient(context, data.take_flight_params(), data.table_entry());
     call_options.headers.emplace_back("airport-action-name", "column_statistics");
     AIRPORT_MSGPACK_ACTION_SINGLE_PARAMETER(action, "column_statistics", params);
 
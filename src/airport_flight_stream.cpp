@@ -9,8 +9,12 @@
 #include <arrow/flight/client.h>
 #include <arrow/flight/types.h>
 
+#include <condition_variable>
+#include <deque>
 #include <iostream>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <arrow/buffer.h>
 #include <arrow/filesystem/api.h>
 #include <arrow/filesystem/localfs.h>
@@ -19,6 +23,7 @@
 #include <arrow/io/api.h>
 #include <arrow/ipc/api.h>
 #include <arrow/util/align_util.h>
+#include <arrow/util/byte_size.h>
 #include <arrow/util/uri.h>
 #include "msgpack.hpp"
 #include "airport_secrets.hpp"
@@ -321,6 +326,8 @@ namespace duckdb
     local_state = func.init_local(execution_context, input, global_state.get());
   }
 
+  // Sent by servers in the app_metadata of a batch, progress is the fraction
+  // of the endpoint that has been sent, from 0.0 to 1.0.
   struct AirportScannerProgress
   {
     double progress;
@@ -328,6 +335,65 @@ namespace duckdb
     MSGPACK_DEFINE_MAP(progress)
   };
 
+  // Sum the sizes of the buffers that were replaced when realigning an array.
+  static idx_t AirportRealignedBufferBytes(const arrow::ArrayData &original, const arrow::ArrayData &aligned)
+  {
+    idx_t total = 0;
+    for (size_t i = 0; i < original.buffers.size() && i < aligned.buffers.size(); i++)
+    {
+      auto &before = original.buffers[i];
+      auto &after = aligned.buffers[i];
+      if (before && after && before->data() != after->data())
+      {
+        total += (idx_t)after->size();
+      }
+    }
+    for (size_t i = 0; i < original.child_data.size() && i < aligned.child_data.size(); i++)
+    {
+      total += AirportRealignedBufferBytes(*original.child_data[i], *aligned.child_data[i]);
+    }
+    if (original.dictionary && aligned.dictionary)
+    {
+      total += AirportRealignedBufferBytes(*original.dictionary, *aligned.dictionary);
+    }
+    return total;
+  }
+
+  // Batches received over gRPC are often sliced out of the message at
+  // arbitrary offsets. Rather than aligning every buffer to 8 bytes, only
+  // require the natural alignment of each buffer's value type (so string
+  // data and validity bitmaps are never copied), and only copy the buffers
+  // that don't meet it. The number of bytes copied is added to realigned_bytes.
+  static arrow::Result<std::shared_ptr<arrow::RecordBatch>> AirportEnsureAlignment(
+      const std::shared_ptr<arrow::RecordBatch> &batch,
+      arrow::MemoryPool *memory_pool,
+      atomic<idx_t> *realigned_bytes)
+  {
+    std::vector<bool> needs_alignment;
+    if (arrow::util::CheckAlignment(*batch, arrow::util::kValueAlignment, &needs_alignment))
+    {
+      return batch;
+    }
+
+    ARROW_ASSIGN_OR_RAISE(auto aligned,
+                          arrow::util::EnsureAlignment(batch, arrow::util::kValueAlignment, memory_pool));
+
+    if (realigned_bytes)
+    {
+      idx_t copied = 0;
+      for (int i = 0; i < batch->num_columns(); i++)
+      {
+        if (i < (int)needs_alignment.size() && needs_alignment[i])
+        {
+          copied += AirportRealignedBufferBytes(*batch->column_data(i), *aligned->column_data(i));
+        }
+      }
+      realigned_bytes->fetch_add(copied, std::memory_order_relaxed);
+    }
+
+    return aligned;
+  }
+
   class FlightMetadataRecordBatchReaderAdapter : public arrow::RecordBatchReader, public AirportLocationDescriptor
   {
   public:
@@ -341,6 +407,9 @@ namespace duckdb
         const AirportLocationDescriptor &location_descriptor,
         atomic<double> *progress,
         std::shared_ptr<arrow::Buffer> *last_app_metadata,
+        atomic<idx_t> *realigned_bytes,
+        atomic<idx_t> *bytes_read,
+        arrow::MemoryPool *memory_pool,
         const std::shared_ptr<arrow::Schema> &schema,
         ReaderDelegate delegate)
         : AirportLocationDescriptor(location_descriptor),
@@ -348,6 +417,9 @@ namespace duckdb
           delegate_(std::move(delegate)),
           progress_(progress),
           last_app_metadata_(last_app_metadata),
+          realigned_bytes_(realigned_bytes),
+          bytes_read_(bytes_read),
+          memory_pool_(memory_pool),
           batch_index_(0)
     {
     }
@@ -370,11 +442,12 @@ namespace duckdb
           {
             AIRPORT_ASSIGN_OR_RAISE_CONTAINER(
                 auto aligned_chunk,
-                arrow::util::EnsureAlignment(batch_result, 8, arrow::default_memory_pool()),
+                AirportEnsureAlignment(batch_result, memory_pool_, realigned_bytes_),
                 this,
                 "EnsureRecordBatchAlignment");
 
             *batch = aligned_chunk;
+            CountBytesRead(*batch);
 
             return arrow::Status::OK();
           }
@@ -393,11 +466,12 @@ namespace duckdb
           {
             AIRPORT_ASSIGN_OR_RAISE_CONTAINER(
                 auto aligned_chunk,
-                arrow::util::EnsureAlignment(batch_result, 8, arrow::default_memory_pool()),
+                AirportEnsureAlignment(batch_result, memory_pool_, realigned_bytes_),
                 this,
                 "EnsureRecordBatchAlignment");
 
             *batch = aligned_chunk;
+            CountBytesRead(*batch);
 
             return arrow::Status::OK();
           }
@@ -443,11 +517,12 @@ namespace duckdb
           {
             AIRPORT_ASSIGN_OR_RAISE_CONTAINER(
                 auto aligned_chunk,
-                arrow::util::EnsureAlignment(chunk.data, 8, arrow::default_memory_pool()),
+                AirportEnsureAlignment(chunk.data, memory_pool_, realigned_bytes_),
                 this,
                 "EnsureRecordBatchAlignment");
 
             *batch = aligned_chunk;
+            CountBytesRead(*batch);
           }
           else
           {
@@ -460,16 +535,158 @@ namespace duckdb
     }
 
   private:
+    void CountBytesRead(const std::shared_ptr<arrow::RecordBatch> &batch)
+    {
+      if (bytes_read_)
+      {
+        bytes_read_->fetch_add((idx_t)arrow::util::TotalBufferSize(*batch), std::memory_order_relaxed);
+      }
+    }
+
     const std::shared_ptr<arrow::Schema> schema_;
 
     const ReaderDelegate delegate_;
 
     atomic<double> *progress_;
     std::shared_ptr<arrow::Buffer> *last_app_metadata_;
+    atomic<idx_t> *realigned_bytes_;
+    atomic<idx_t> *bytes_read_;
+    arrow::MemoryPool *memory_pool_;
 
     size_t batch_index_;
   };
 
+  // Reads record batches from another reader on a background thread, so the
+  // network transfer and IPC decoding of the following batches overlap with
+  // the conversion of the current batch to DuckDB vectors.
+  //
+  // The queue is bounded by the number of bytes it holds, but a single batch
+  // is always allowed so that a batch larger than the limit can't stall the
+  // stream.
+  class AirportPrefetchingRecordBatchReader : public arrow::RecordBatchReader
+  {
+  public:
+    explicit AirportPrefetchingRecordBatchReader(
+        std::shared_ptr<arrow::RecordBatchReader> source,
+        std::shared_ptr<arrow::flight::FlightStreamReader> flight_reader,
+        const idx_t max_bytes)
+        : source_(std::move(source)),
+          flight_reader_(std::move(flight_reader)),
+          max_bytes_(max_bytes)
+    {
+      thread_ = std::thread([this]()
+                            { Run(); });
+    }
+
+    ~AirportPrefetchingRecordBatchReader() override
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+      }
+      producer_cv_.notify_all();
+
+      // If the reading thread is blocked waiting on the network, cancel
+      // the call so it returns promptly.
+      if (!finished_ && flight_reader_)
+      {
+        flight_reader_->Cancel();
+      }
+
+      if (thread_.joinable())
+      {
+        thread_.join();
+      }
+    }
+
+    std::shared_ptr<arrow::Schema> schema() const override { return source_->schema(); }
+
+    arrow::Status ReadNext(std::shared_ptr<arrow::RecordBatch> *batch) override
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      consumer_cv_.wait(lock, [this]()
+                        { return !queue_.empty() || finished_; });
+
+      if (!queue_.empty())
+      {
+        auto &front = queue_.front();
+        *batch = std::move(front.first);
+        queued_bytes_ -= front.second;
+        queue_.pop_front();
+        lock.unlock();
+        producer_cv_.notify_one();
+        return arrow::Status::OK();
+      }
+
+      *batch = nullptr;
+      if (error_)
+      {
+        std::rethrow_exception(error_);
+      }
+      return status_;
+    }
+
+  private:
+    void Run()
+    {
+      while (true)
+      {
+        std::shared_ptr<arrow::RecordBatch> batch;
+        arrow::Status status;
+        try
+        {
+          status = source_->ReadNext(&batch);
+        }
+        catch (...)
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          error_ = std::current_exception();
+          finished_ = true;
+          consumer_cv_.notify_one();
+          return;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!status.ok() || batch == nullptr)
+        {
+          status_ = status;
+          finished_ = true;
+          consumer_cv_.notify_one();
+          return;
+        }
+
+        const idx_t batch_bytes = (idx_t)arrow::util::TotalBufferSize(*batch);
+        producer_cv_.wait(lock, [this, batch_bytes]()
+                          { return stopping_ || queue_.empty() || queued_bytes_ + batch_bytes <= max_bytes_; });
+        if (stopping_)
+        {
+          finished_ = true;
+          return;
+        }
+
+        queue_.emplace_back(std::move(batch), batch_bytes);
+        queued_bytes_ += batch_bytes;
+        consumer_cv_.notify_one();
+      }
+    }
+
+    const std::shared_ptr<arrow::RecordBatchReader> source_;
+    const std::shared_ptr<arrow::flight::FlightStreamReader> flight_reader_;
+    const idx_t max_bytes_;
+
+    std::mutex mutex_;
+    std::condition_variable producer_cv_;
+    std::condition_variable consumer_cv_;
+    std::deque<std::pair<std::shared_ptr<arrow::RecordBatch>, idx_t>> queue_;
+    idx_t queued_bytes_ = 0;
+    std::atomic<bool> finished_ = false;
+    bool stopping_ = false;
+    arrow::Status status_;
+    std::exception_ptr error_;
+
+    std::thread thread_;
+  };
+
   /// Arrow array stream factory function
   duckdb::unique_ptr<duckdb::ArrowArrayStreamWrapper>
   AirportCreateStream(uintptr_t buffer_ptr,
@@ -488,16 +705,35 @@ namespace duckdb
         *airport_parameters,
         airport_parameters->progress,
         airport_parameters->last_app_metadata,
+        local_state->realigned_bytes,
+        local_state->bytes_read,
+        local_state->memory_pool,
         airport_parameters->schema(),
         local_state->reader());
 
+    std::shared_ptr<arrow::RecordBatchReader> stream_reader = reader;
+
+    // DoGet streams are prefetched when the scan asks for it. Exchanges
+    // interleave writes and reads so they stay in lock step with the
+    // caller, unless like pipelined scalar functions they ask for their
+    // results to be read while more is written.
+    auto &delegate = local_state->reader();
+    if (local_state->prefetch_max_bytes > 0 &&
+        std::holds_alternative<std::shared_ptr<arrow::flight::FlightStreamReader>>(delegate))
+    {
+      stream_reader = std::make_shared<AirportPrefetchingRecordBatchReader>(
+          reader,
+          std::get<std::shared_ptr<arrow::flight::FlightStreamReader>>(delegate),
+          local_state->prefetch_max_bytes);
+    }
+
     // Create arrow stream
     //    auto stream_wrapper = duckdb::make_uniq<duckdb::ArrowArrayStreamWrapper>();
     auto stream_wrapper = duckdb::make_uniq<AirportArrowArrayStreamWrapper>(*airport_parameters);
     stream_wrapper->arrow_array_stream.release = nullptr;
 
     auto maybe_ok = arrow::ExportRecordBatchReader(
-        reader, &stream_wrapper->arrow_array_stream);
+        stream_reader, &stream_wrapper->arrow_array_stream);
 
     if (!maybe_ok.ok())
     {
@@ -27,6 +27,9 @@ namespace duckdb
     // This is the auth token.
     string auth_token;
 
+    // The name of the secret to use.
+    string secret_name;
+
     // This is the criteria that will be passed the list flights.
     string criteria;
 
@@ -54,7 +57,7 @@ namespace duckdb
     {
       const auto &bind_data = input.bind_data->Cast<ListFlightsBindData>();
 
-      auto flight_client = AirportAPI::FlightClientForLocation(bind_data.server_location);
+      auto flight_client = AirportAPI::FlightClientForLocation(context, bind_data.server_location, bind_data.secret_name);
 
       return make_uniq<ListFlightsGlobalState>(flight_client);
     }
@@ -93,6 +96,7 @@ namespace duckdb
     auto ret = make_uniq<ListFlightsBindData>();
     ret->server_location = server_location;
     ret->auth_token = auth_token;
+    ret->secret_name = secret_name;
     ret->criteria = criteria;
 
     // ordered - boolean
@@ -0,0 +1,177 @@
+#include "duckdb.hpp"
+#include "duckdb/main/client_context.hpp"
+#include "duckdb/storage/buffer_manager.hpp"
+#include "airport_extension.hpp"
+#include "airport_memory_pool.hpp"
+
+namespace duckdb
+{
+  // Zero sized allocations all return this address, like Arrow's own pools.
+  alignas(64) static uint8_t airport_zero_size_area[1];
+
+  // Every allocation is over-allocated so it can be aligned, the pointer
+  // returned by the allocator is stored just before the aligned address.
+  static idx_t AirportAllocationSize(int64_t size, int64_t alignment)
+  {
+    return (idx_t)size + (idx_t)alignment + sizeof(data_ptr_t);
+  }
+
+  AirportMemoryPool::AirportMemoryPool(shared_ptr<DatabaseInstance> db)
+      : db_(std::move(db)), allocator_(BufferAllocator::Get(*db_))
+  {
+  }
+
+  void AirportMemoryPool::Release()
+  {
+    if (references_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+      delete this;
+    }
+  }
+
+  void AirportMemoryPool::UpdateAllocated(int64_t diff)
+  {
+    auto allocated = bytes_allocated_.fetch_add(diff, std::memory_order_relaxed) + diff;
+    if (diff > 0)
+    {
+      total_bytes_allocated_.fetch_add(diff, std::memory_order_relaxed);
+      num_allocations_.fetch_add(1, std::memory_order_relaxed);
+
+      auto peak = max_memory_.load(std::memory_order_relaxed);
+      while (allocated > peak && !max_memory_.compare_exchange_weak(peak, allocated, std::memory_order_relaxed))
+      {
+      }
+    }
+  }
+
+  arrow::Status AirportMemoryPool::Allocate(int64_t size, int64_t alignment, uint8_t **out)
+  {
+    if (size < 0)
+    {
+      return arrow::Status::Invalid("negative allocation size requested");
+    }
+    if (size == 0)
+    {
+      *out = airport_zero_size_area;
+      return arrow::Status::OK();
+    }
+
+    data_ptr_t raw;
+    try
+    {
+      raw = allocator_.AllocateData(AirportAllocationSize(size, alignment));
+    }
+    catch (std::exception &ex)
+    {
+      // Typically this is DuckDB reporting that the memory limit was reached.
+      return arrow::Status::OutOfMemory(ex.what());
+    }
+
+    auto address = reinterpret_cast<uintptr_t>(raw + sizeof(data_ptr_t));
+    address = (address + (uintptr_t)alignment - 1) & ~((uintptr_t)alignment - 1);
+    reinterpret_cast<data_ptr_t *>(address)[-1] = raw;
+
+    *out = reinterpret_cast<uint8_t *>(address);
+    references_.fetch_add(1, std::memory_order_relaxed);
+    UpdateAllocated(size);
+    return arrow::Status::OK();
+  }
+
+  void AirportMemoryPool::Free(uint8_t *buffer, int64_t size, int64_t alignment)
+  {
+    if (buffer == airport_zero_size_area)
+    {
+      return;
+    }
+    auto raw = reinterpret_cast<data_ptr_t *>(buffer)[-1];
+    allocator_.FreeData(raw, AirportAllocationSize(size, alignment));
+    UpdateAllocated(-size);
+    // This can be the last reference to the pool once its connection is gone.
+    Release();
+  }
+
+  arrow::Status AirportMemoryPool::Reallocate(int64_t old_size, int64_t new_size, int64_t alignment, uint8_t **ptr)
+  {
+    if (old_size == new_size)
+    {
+      return arrow::Status::OK();
+    }
+
+    uint8_t *result;
+    ARROW_RETURN_NOT_OK(Allocate(new_size, alignment, &result));
+    if (old_size > 0 && new_size > 0)
+    {
+      memcpy(result, *ptr, (size_t)MinValue<int64_t>(old_size, new_size));
+    }
+    Free(*ptr, old_size, alignment);
+    *ptr = result;
+    return arrow::Status::OK();
+  }
+
+  AirportMemoryPoolState::AirportMemoryPoolState(ClientContext &context)
+      : pool_(new AirportMemoryPool(context.db))
+  {
+  }
+
+  AirportMemoryPoolState::~AirportMemoryPoolState()
+  {
+    // Arrow buffers that are still alive keep the pool until they are freed.
+    pool_->Release();
+  }
+
+  AirportMemoryPool &AirportMemoryPool::Get(ClientContext &context)
+  {
+    return context.registered_state->GetOrCreate<AirportMemoryPoolState>("airport_memory_pool", context)->pool();
+  }
+
+  void AirportUseMemoryPool(ClientContext &context, arrow::flight::FlightCallOptions &call_options)
+  {
+    auto &pool = AirportMemoryPool::Get(context);
+    call_options.read_options.memory_pool = &pool;
+    call_options.write_options.memory_pool = &pool;
+  }
+
+  struct AirportMemoryUsageFunctionData : public TableFunctionData
+  {
+    bool finished = false;
+  };
+
+  static unique_ptr<FunctionData> AirportMemoryUsageBind(ClientContext &context, TableFunctionBindInput &input,
+                                                         vector<LogicalType> &return_types, vector<string> &names)
+  {
+    names.emplace_back("bytes_allocated");
+    return_types.emplace_back(LogicalType::BIGINT);
+    names.emplace_back("peak_bytes");
+    return_types.emplace_back(LogicalType::BIGINT);
+    names.emplace_back("last_query_peak_bytes");
+    return_types.emplace_back(LogicalType::BIGINT);
+    names.emplace_back("total_bytes_allocated");
+    return_types.emplace_back(LogicalType::BIGINT);
+    names.emplace_back("allocations");
+    return_types.emplace_back(LogicalType::BIGINT);
+    return make_uniq<AirportMemoryUsageFunctionData>();
+  }
+
+  static void AirportMemoryUsageFunction(ClientContext &context, TableFunctionInput &data_p, DataChunk &output)
+  {
+    auto &data = data_p.bind_data->CastNoConst<AirportMemoryUsageFunctionData>();
+    if (data.finished)
+    {
+      return;
+    }
+    auto &pool = AirportMemoryPool::Get(context);
+    output.SetValue(0, 0, Value::BIGINT(pool.bytes_allocated()));
+    output.SetValue(1, 0, Value::BIGINT(pool.max_memory()));
+    output.SetValue(2, 0, Value::BIGINT(pool.last_query_peak()));
+    output.SetValue(3, 0, Value::BIGINT(pool.total_bytes_allocated()));
+    output.SetValue(4, 0, Value::BIGINT(pool.num_allocations()));
+    output.SetCardinality(1);
+    data.finished = true;
+  }
+
+  void AirportAddMemoryUsageFunction(ExtensionLoader &loader)
+  {
+    TableFunction memory_usage_function("airport_memory_usage", {}, AirportMemoryUsageFunction, AirportMemoryUsageBind);
+    loader.RegisterFunction(memory_usage_function);
+  }
+}
@@ -9,6 +9,7 @@
 #include "duckdb/catalog/catalog_entry/table_catalog_entry.hpp"
 #include "airport_flight_stream.hpp"
 #include "storage/airport_table_entry.hpp"
+#include "airport_scalar_function_pipeline.hpp"
 
 namespace duckdb
 {
@@ -76,5 +77,6 @@ namespace duckdb
   {
     OptimizeAirportUpdate(plan);
     OptimizeAirportDelete(plan);
+    AirportPipelineScalarFunctions(input, plan);
   }
 }
\ No newline at end of file
@@ -9,6 +9,7 @@
 #include "airport_request_headers.hpp"
 #include "airport_macros.hpp"
 #include "airport_secrets.hpp"
+#include "airport_settings.hpp"
 #include "duckdb/common/arrow/arrow_appender.hpp"
 #include "airport_flight_stream.hpp"
 #include "storage/airport_exchange.hpp"
@@ -16,166 +17,15 @@
 #include "airport_location_descriptor.hpp"
 #include "airport_schema_utils.hpp"
 #include "storage/airport_transaction.hpp"
+#include "storage/airport_catalog.hpp"
+#include "duckdb/common/vector_operations/vector_operations.hpp"
+#include "duckdb/common/operator/comparison_operators.hpp"
+#include "airport_flight_exception.hpp"
 #include <numeric>
 
 namespace duckdb
 {
 
-  // So the local state of an airport provided scalar function is going to setup a
-  // lot of the functionality necessary.
-  //
-  // Its going to create the flight client, call the DoExchange endpoint,
-  //
-  // Its going to send the schema of the stream that we're going to write to the server
-  // and its going to read the schema of the strema that is returned.
-  struct AirportScalarFunctionLocalState : public FunctionLocalState, public AirportLocationDescriptor
-  {
-    explicit AirportScalarFunctionLocalState(ClientContext &context,
-                                             const AirportLocationDescriptor &location_descriptor,
-                                             const std::shared_ptr<arrow::Schema> &function_output_schema,
-                                             const std::shared_ptr<arrow::Schema> &function_input_schema,
-                                             const std::optional<std::string> &transaction_id)
-        : AirportLocationDescriptor(location_descriptor),
-          function_output_schema_(function_output_schema),
-          function_input_schema_(function_input_schema),
-          transaction_id_(transaction_id)
-    {
-      const auto trace_id = airport_trace_id();
-
-      auto &server_location = this->server_location();
-      // Create the client
-      auto flight_client = AirportAPI::FlightClientForLocation(server_location);
-
-      arrow::flight::FlightCallOptions call_options;
-
-      // Lookup the auth token from the secret storage.
-
-      auto auth_token = AirportAuthTokenForLocation(context,
-                                                    server_location,
-                                                    "", "");
-      // FIXME: there may need to be a way for the user to supply the auth token
-      // but since scalar functions are defined by the server, just assume the user
-      // has the token persisted in their secret store.
-      airport_add_standard_headers(call_options, server_location);
-      airport_add_authorization_header(call_options, auth_token);
-      airport_add_trace_id_header(call_options, trace_id);
-
-      // Indicate that we are doing a delete.
-      call_options.headers.emplace_back("airport-operation", "scalar_function");
-
-      // Indicate if the caller is interested in data being returned.
-      call_options.headers.emplace_back("return-chunks", "1");
-
-      if (transaction_id)
-      {
-        call_options.headers.emplace_back("airport-transaction-id", *transaction_id);
-      }
-
-      airport_add_flight_path_header(call_options, this->descriptor());
-
-      AIRPORT_ASSIGN_OR_RAISE_CONTAINER(
-          auto exchange_result,
-          flight_client->DoExchange(call_options, this->descriptor()),
-          this, "");
-
-      // Tell the server the schema that we will be using to write data.
-      AIRPORT_ARROW_ASSERT_OK_CONTAINER(
-          exchange_result.writer->Begin(function_input_schema_),
-          this,
-          "Begin schema");
-
-      scan_bind_data_ = make_uniq<AirportExchangeTakeFlightBindData>(
-          (stream_factory_produce_t)&AirportCreateStream,
-          trace_id,
-          -1,
-          AirportTakeFlightParameters(server_location, context),
-          std::nullopt,
-          function_output_schema_,
-          this->descriptor(),
-          nullptr);
-
-      // Read the schema for the results being returned.
-      AIRPORT_ASSIGN_OR_RAISE_CONTAINER(auto read_schema,
-                                        exchange_result.reader->GetSchema(),
-                                        this,
-                                        "");
-
-      // Ensure that the schema of the response matches the one that was
-      // returned on the flight info object.
-      AIRPORT_ASSERT_OK_CONTAINER(function_output_schema_->Equals(*read_schema),
-                                  this,
-                                  "Schema equality check");
-
-      // Convert the Arrow schema to the C format schema.
-
-      scan_bind_data_->examine_schema(context, false);
-
-      // There should only be a single output column.
-      D_ASSERT(scan_bind_data_->names().size() == 1);
-
-      writer_ = std::move(exchange_result.writer);
-
-      // Just fake a single column index.
-      vector<column_t> column_ids = {0};
-
-      // So you need some endpoints here.
-      scan_global_state_ = make_uniq<AirportArrowScanGlobalState>();
-
-      // There shouldn't be any projection ids.
-      vector<idx_t> projection_ids;
-
-      auto fake_init_input = TableFunctionInitInput(
-          &scan_bind_data_->Cast<FunctionData>(),
-          column_ids,
-          projection_ids,
-          nullptr);
-
-      auto current_chunk = make_uniq<ArrowArrayWrapper>();
-      scan_local_state_ = make_uniq<AirportArrowScanLocalState>(
-          std::move(current_chunk),
-          context,
-          std::move(exchange_result.reader), fake_init_input);
-      scan_local_state_->set_stream(
-          AirportProduceArrowScan(
-              *scan_bind_data_,
-              column_ids,
-              nullptr,
-              // No progress reporting.
-              nullptr,
-              // No need for the last metadata message
-              nullptr,
-              scan_bind_data_->schema(),
-              *this,
-              *scan_local_state_));
-      scan_local_state_->column_ids = fake_init_input.column_ids;
-      scan_local_state_->filters = fake_init_input.filters.get();
-    }
-
-  public:
-    const std::shared_ptr<arrow::Schema> &function_input_schema() const
-    {
-      return function_input_schema_;
-    }
-
-    const std::shared_ptr<arrow::Schema> &function_output_schema() const
-    {
-      return function_output_schema_;
-    }
-
-    void process_chunk(DataChunk &args, ExpressionState &state, Vector &result);
-
-  private:
-    std::unique_ptr<AirportExchangeTakeFlightBindData> scan_bind_data_;
-    std::unique_ptr<AirportArrowScanGlobalState> scan_global_state_;
-    std::unique_ptr<AirportArrowScanLocalState> scan_local_state_;
-    std::unique_ptr<arrow::flight::FlightStreamWriter> writer_;
-
-    const std::shared_ptr<arrow::Schema> function_output_schema_;
-    const std::shared_ptr<arrow::Schema> function_input_schema_;
-    const unique_ptr<arrow::flight::FlightClient> flight_client_;
-    const std::optional<std::string> transaction_id_;
-  };
-
   struct AirportScalarFunctionBindData : public FunctionData
   {
   public:
@@ -203,6 +53,143 @@ namespace duckdb
     const std::shared_ptr<arrow::Schema> input_schema_;
   };
 
+  AirportScalarFunctionLocalState::AirportScalarFunctionLocalState(ClientContext &context,
+                                                                   std::shared_ptr<arrow::flight::FlightClient> flight_client,
+                                                                   const AirportLocationDescriptor &location_descriptor,
+                                                                   const std::shared_ptr<arrow::Schema> &function_output_schema,
+                                                                   const std::shared_ptr<arrow::Schema> &function_input_schema,
+                                                                   const std::optional<std::string> &transaction_id,
+                                                                   bool read_ahead,
+                                                                   bool deduplicate_arguments,
+                                                                   shared_ptr<AirportScalarFunctionCache::Function> cache_function)
+      : AirportLocationDescriptor(location_descriptor),
+        deduplicate_arguments_(deduplicate_arguments),
+        cache_function_(std::move(cache_function)),
+        flight_client_(std::move(flight_client)),
+        function_output_schema_(function_output_schema),
+        function_input_schema_(function_input_schema),
+        transaction_id_(transaction_id)
+  {
+    const auto trace_id = airport_trace_id();
+
+    auto &server_location = this->server_location();
+
+    arrow::flight::FlightCallOptions call_options;
+
+    // Lookup the auth token from the secret storage.
+
+    auto auth_token = AirportAuthTokenForLocation(context,
+                                                  server_location,
+                                                  "", "");
+    // FIXME: there may need to be a way for the user to supply the auth token
+    // but since scalar functions are defined by the server, just assume the user
+    // has the token persisted in their secret store.
+    airport_add_standard_headers(call_options, server_location);
+    airport_add_authorization_header(call_options, auth_token);
+    airport_add_trace_id_header(call_options, trace_id);
+
+    // Indicate that we are doing a delete.
+    call_options.headers.emplace_back("airport-operation", "scalar_function");
+
+    // Indicate if the caller is interested in data being returned.
+    call_options.headers.emplace_back("return-chunks", "1");
+
+    if (transaction_id)
+    {
+      call_options.headers.emplace_back("airport-transaction-id", *transaction_id);
+    }
+
+    airport_add_flight_path_header(call_options, this->descriptor());
+
+    AirportUseMemoryPool(context, call_options);
+
+    AirportUseIpcCompression(context, call_options);
+
+    AIRPORT_ASSIGN_OR_RAISE_CONTAINER(
+        auto exchange_result,
+        flight_client_->DoExchange(call_options, this->descriptor()),
+        this, "");
+
+    // Tell the server the schema that we will be using to write data.
+    AIRPORT_ARROW_ASSERT_OK_CONTAINER(
+        exchange_result.writer->Begin(function_input_schema_, call_options.write_options),
+        this,
+        "Begin schema");
+
+    scan_bind_data_ = make_uniq<AirportExchangeTakeFlightBindData>(
+        (stream_factory_produce_t)&AirportCreateStream,
+        trace_id,
+        -1,
+        AirportTakeFlightParameters(server_location, context),
+        std::nullopt,
+        function_output_schema_,
+        this->descriptor(),
+        nullptr);
+
+    // Read the schema for the results being returned.
+    AIRPORT_ASSIGN_OR_RAISE_CONTAINER(auto read_schema,
+                                      exchange_result.reader->GetSchema(),
+                                      this,
+                                      "");
+
+    // Ensure that the schema of the response matches the one that was
+    // returned on the flight info object.
+    AIRPORT_ASSERT_OK_CONTAINER(function_output_schema_->Equals(*read_schema),
+                                this,
+                                "Schema equality check");
+
+    // Convert the Arrow schema to the C format schema.
+
+    scan_bind_data_->examine_schema(context, false);
+
+    // There should only be a single output column.
+    D_ASSERT(scan_bind_data_->names().size() == 1);
+
+    writer_ = std::move(exchange_result.writer);
+
+    // Just fake a single column index.
+    vector<column_t> column_ids = {0};
+
+    // So you need some endpoints here.
+    scan_global_state_ = make_uniq<AirportArrowScanGlobalState>();
+
+    // There shouldn't be any projection ids.
+    vector<idx_t> projection_ids;
+
+    auto fake_init_input = TableFunctionInitInput(
+        &scan_bind_data_->Cast<FunctionData>(),
+        column_ids,
+        projection_ids,
+        nullptr);
+
+    auto current_chunk = make_uniq<ArrowArrayWrapper>();
+    scan_local_state_ = make_uniq<AirportArrowScanLocalState>(
+        std::move(current_chunk),
+        context,
+        std::move(exchange_result.reader), fake_init_input);
+    if (read_ahead)
+    {
+      // The results that can be unread are limited by the chunks that are
+      // kept in flight, so the queue doesn't need a limit of its own. One
+      // would bring back the chance of both sides waiting on each other.
+      scan_local_state_->prefetch_max_bytes = NumericLimits<idx_t>::Maximum();
+    }
+    scan_local_state_->set_stream(
+        AirportProduceArrowScan(
+            *scan_bind_data_,
+            column_ids,
+            nullptr,
+            // No progress reporting.
+            nullptr,
+            // No need for the last metadata message
+            nullptr,
+            scan_bind_data_->schema(),
+            *this,
+            *scan_local_state_));
+    scan_local_state_->column_ids = fake_init_input.column_ids;
+    scan_local_state_->filters = fake_init_input.filters.get();
+  }
+
   unique_ptr<FunctionData> AirportScalarFunctionBind(ClientContext &context, ScalarFunction &bound_function,
                                                      vector<unique_ptr<Expression>> &arguments)
   {
@@ -293,17 +280,320 @@ namespace duckdb
   void AirportScalarFunctionLocalState::process_chunk(DataChunk &args, ExpressionState &state, Vector &result)
   {
     auto &context = state.GetContext();
+    send_chunk(context, args);
+    receive_result(context, args.size(), result);
+  }
+
+  void AirportScalarFunctionLocalState::send_chunk(ClientContext &context, DataChunk &args)
+  {
+    vector<reference<DataChunk>> chunks = {args};
+    send_chunks(context, chunks);
+  }
+
+  template <class T>
+  static bool AirportArgumentsAreEqual(const UnifiedVectorFormat &left, idx_t left_row,
+                                       const UnifiedVectorFormat &right, idx_t right_row)
+  {
+    const auto left_idx = left.sel->get_index(left_row);
+    const auto right_idx = right.sel->get_index(right_row);
+    const auto left_valid = left.validity.RowIsValid(left_idx);
+    const auto right_valid = right.validity.RowIsValid(right_idx);
+    if (!left_valid || !right_valid)
+    {
+      // NULL arguments are the same as each other.
+      return left_valid == right_valid;
+    }
+    return Equals::Operation<T>(UnifiedVectorFormat::GetData<T>(left)[left_idx],
+                                UnifiedVectorFormat::GetData<T>(right)[right_idx]);
+  }
+
+  // Floating point arguments are compared on their bits, -0.0 and 0.0 are
+  // equal as numbers but a function can still tell them apart (1/x). This
+  // matches the keys of the scalar function cache.
+  template <class T>
+  static bool AirportFloatArgumentsAreEqual(const UnifiedVectorFormat &left, idx_t left_row,
+                                            const UnifiedVectorFormat &right, idx_t right_row)
+  {
+    const auto left_idx = left.sel->get_index(left_row);
+    const auto right_idx = right.sel->get_index(right_row);
+    const auto left_valid = left.validity.RowIsValid(left_idx);
+    const auto right_valid = right.validity.RowIsValid(right_idx);
+    if (!left_valid || !right_valid)
+    {
+      return left_valid == right_valid;
+    }
+    return memcmp(&UnifiedVectorFormat::GetData<T>(left)[left_idx],
+                  &UnifiedVectorFormat::GetData<T>(right)[right_idx], sizeof(T)) == 0;
+  }
+
+  // Compare the arguments of two rows on their physical values, nested
+  // types are rare enough as arguments to be compared as Values.
+  static bool AirportRowsAreEqual(const DataChunk &left, const vector<UnifiedVectorFormat> &left_format, idx_t left_row,
+                                  const DataChunk &right, const vector<UnifiedVectorFormat> &right_format, idx_t right_row)
+  {
+    for (idx_t col = 0; col < left.ColumnCount(); col++)
+    {
+      auto &l = left_format[col];
+      auto &r = right_format[col];
+      bool equal;
+      switch (left.data[col].GetType().InternalType())
+      {
+      case PhysicalType::BOOL:
+        equal = AirportArgumentsAreEqual<bool>(l, left_row, r, right_row);
+        break;
+      case PhysicalType::INT8:
+        equal = AirportArgumentsAreEqual<int8_t>(l, left_row, r, right_row);
+        break;
+      case PhysicalType::INT16:
+        equal = AirportArgumentsAreEqual<int16_t>(l, left_row, r, right_row);
+        break;
+      case PhysicalType::INT32:
+        equal = AirportArgumentsAreEqual<int32_t>(l, left_row, r, right_row);
+        break;
+      case PhysicalType::INT64:
+        equal = AirportArgumentsAreEqual<int64_t>(l, left_row, r, right_row);
+        break;
+      case PhysicalType::INT128:
+        equal = AirportArgumentsAreEqual<hugeint_t>(l, left_row, r, right_row);
+        break;
+      case PhysicalType::UINT8:
+        equal = AirportArgumentsAreEqual<uint8_t>(l, left_row, r, right_row);
+        break;
+      case PhysicalType::UINT16:
+        equal = AirportArgumentsAreEqual<uint16_t>(l, left_row, r, right_row);
+        break;
+      case PhysicalType::UINT32:
+        equal = AirportArgumentsAreEqual<uint32_t>(l, left_row, r, right_row);
+        break;
+      case PhysicalType::UINT64:
+        equal = AirportArgumentsAreEqual<uint64_t>(l, left_row, r, right_row);
+        break;
+      case PhysicalType::UINT128:
+        equal = AirportArgumentsAreEqual<uhugeint_t>(l, left_row, r, right_row);
+        break;
+      case PhysicalType::FLOAT:
+        equal = AirportFloatArgumentsAreEqual<float>(l, left_row, r, right_row);
+        break;
+      case PhysicalType::DOUBLE:
+        equal = AirportFloatArgumentsAreEqual<double>(l, left_row, r, right_row);
+        break;
+      case PhysicalType::INTERVAL:
+        equal = AirportArgumentsAreEqual<interval_t>(l, left_row, r, right_row);
+        break;
+      case PhysicalType::VARCHAR:
+        equal = AirportArgumentsAreEqual<string_t>(l, left_row, r, right_row);
+        break;
+      default:
+        equal = Value::NotDistinctFrom(left.GetValue(col, left_row), right.GetValue(col, right_row));
+        break;
+      }
+      if (!equal)
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void AirportScalarFunctionLocalState::send_chunks(ClientContext &context, const vector<reference<DataChunk>> &chunks)
+  {
+    D_ASSERT(!chunks.empty());
+    if (cache_function_)
+    {
+      send_cached_chunks(context, chunks);
+      return;
+    }
+    if (!deduplicate_arguments_)
+    {
+      write_batch(context, chunks);
+      return;
+    }
+
+    DeduplicatedBatch batch;
+    DataChunk distinct;
+
+    auto &first = chunks[0].get();
+    optional_idx dictionary_size;
+    if (chunks.size() == 1 && first.ColumnCount() == 1 &&
+        first.data[0].GetVectorType() == VectorType::DICTIONARY_VECTOR)
+    {
+      dictionary_size = DictionaryVector::DictionarySize(first.data[0]);
+    }
+
+    if (dictionary_size.IsValid() && dictionary_size.GetIndex() <= first.size())
+    {
+      // A dictionary already holds the values of the chunk with a selection
+      // over them, so the dictionary is sent as it is.
+      distinct.InitializeEmpty(first.GetTypes());
+      distinct.data[0].Reference(DictionaryVector::Child(first.data[0]));
+      distinct.SetCardinality(dictionary_size.GetIndex());
+      batch.distinct_rows = dictionary_size.GetIndex();
+
+      auto &dictionary_sel = DictionaryVector::SelVector(first.data[0]);
+      DeduplicatedChunk entry;
+      entry.count = first.size();
+      entry.rows.Initialize(first.size());
+      for (idx_t row = 0; row < first.size(); row++)
+      {
+        entry.rows.set_index(row, dictionary_sel.get_index(row));
+      }
+      batch.chunks.push_back(std::move(entry));
+    }
+    else
+    {
+      idx_t total_rows = 0;
+      for (auto &chunk : chunks)
+      {
+        total_rows += chunk.get().size();
+      }
+      distinct.Initialize(Allocator::Get(context), first.GetTypes(), total_rows);
+
+      // The distinct rows seen so far by hash, as the chunk and row they
+      // were first seen at.
+      struct DistinctRow
+      {
+        idx_t chunk;
+        idx_t row;
+        idx_t index;
+      };
+      std::unordered_map<hash_t, vector<DistinctRow>> seen;
+      // The arguments of each chunk, for comparing rows with the same hash.
+      vector<vector<UnifiedVectorFormat>> formats(chunks.size());
+
+      for (idx_t chunk_idx = 0; chunk_idx < chunks.size(); chunk_idx++)
+      {
+        auto &chunk = chunks[chunk_idx].get();
+        formats[chunk_idx].resize(chunk.ColumnCount());
+        for (idx_t col = 0; col < chunk.ColumnCount(); col++)
+        {
+          chunk.data[col].ToUnifiedFormat(chunk.size(), formats[chunk_idx][col]);
+        }
+        Vector hashes(LogicalType::HASH, chunk.size());
+        chunk.Hash(hashes);
+        hashes.Flatten(chunk.size());
+        auto hash_data = FlatVector::GetData<hash_t>(hashes);
+
+        DeduplicatedChunk entry;
+        entry.count = chunk.size();
+        entry.rows.Initialize(chunk.size());
+        SelectionVector new_rows(chunk.size());
+        idx_t new_count = 0;
+        for (idx_t row = 0; row < chunk.size(); row++)
+        {
+          auto &candidates = seen[hash_data[row]];
+          optional_idx match;
+          for (auto &candidate : candidates)
+          {
+            if (AirportRowsAreEqual(chunks[candidate.chunk].get(), formats[candidate.chunk], candidate.row,
+                                    chunk, formats[chunk_idx], row))
+            {
+              match = candidate.index;
+              break;
+            }
+          }
+          if (!match.IsValid())
+          {
+            match = batch.distinct_rows + new_count;
+            candidates.push_back({chunk_idx, row, match.GetIndex()});
+            new_rows.set_index(new_count++, row);
+          }
+          entry.rows.set_index(row, match.GetIndex());
+        }
+
+        distinct.Append(chunk, false, &new_rows, new_count);
+        batch.distinct_rows += new_count;
+        batch.chunks.push_back(std::move(entry));
+      }
+    }
+
+    deduplicated_.push_back(std::move(batch));
+    write_batch(context, {distinct});
+  }
+
+  void AirportScalarFunctionLocalState::send_cached_chunks(ClientContext &context, const vector<reference<DataChunk>> &chunks)
+  {
+    auto &cache = AirportScalarFunctionCache::Get();
+    auto &first = chunks[0].get();
+
+    idx_t total_rows = 0;
+    for (auto &chunk : chunks)
+    {
+      total_rows += chunk.get().size();
+    }
+
+    // Only the arguments that aren't cached are sent, once each.
+    DeduplicatedBatch batch;
+    DataChunk misses;
+    misses.Initialize(Allocator::Get(context), first.GetTypes(), total_rows);
+    std::unordered_map<string, idx_t> sent;
+
+    for (auto &chunk_ref : chunks)
+    {
+      auto &chunk = chunk_ref.get();
+      vector<string> arguments;
+      AirportScalarFunctionCache::ArgumentsKeys(chunk, arguments);
+
+      DeduplicatedChunk entry;
+      entry.count = chunk.size();
+      entry.rows.Initialize(chunk.size());
+      entry.cached = make_uniq<Vector>(cache_function_->return_type, MaxValue<idx_t>(chunk.size(), 1));
+      entry.cached_rows = cache.Lookup(*cache_function_, arguments, *entry.cached, entry.is_cached);
+
+      SelectionVector new_rows(chunk.size());
+      idx_t new_count = 0;
+      for (idx_t row = 0; row < chunk.size(); row++)
+      {
+        if (entry.is_cached[row])
+        {
+          entry.rows.set_index(row, 0);
+          continue;
+        }
+        auto found = sent.find(arguments[row]);
+        if (found == sent.end())
+        {
+          found = sent.emplace(arguments[row], batch.distinct_rows + new_count).first;
+          batch.keys.push_back(std::move(arguments[row]));
+          new_rows.set_index(new_count++, row);
+        }
+        entry.rows.set_index(row, found->second);
+      }
+
+      misses.Append(chunk, false, &new_rows, new_count);
+      batch.distinct_rows += new_count;
+      batch.chunks.push_back(std::move(entry));
+    }
+
+    deduplicated_.push_back(std::move(batch));
+    if (misses.size() > 0)
+    {
+      write_batch(context, {misses});
+    }
+  }
+
+  void AirportScalarFunctionLocalState::write_batch(ClientContext &context, const vector<reference<DataChunk>> &chunks)
+  {
+    auto &types = chunks[0].get().GetTypes();
+
+    idx_t row_count = 0;
+    for (auto &chunk : chunks)
+    {
+      row_count += chunk.get().size();
+    }
 
     // So the send schema can contain ANY fields, if it does, we want to dynamically create the schema from
     // what was supplied.
 
-    auto appender = make_uniq<ArrowAppender>(args.GetTypes(),
-                                             args.size(),
+    auto appender = make_uniq<ArrowAppender>(types,
+                                             row_count,
                                              context.GetClientProperties(),
-                                             ArrowTypeExtensionData::GetExtensionTypes(context, args.GetTypes()));
+                                             ArrowTypeExtensionData::GetExtensionTypes(context, types));
 
     // Now that we have the appender append some data.
-    appender->Append(args, 0, args.size(), args.size());
+    for (auto &chunk : chunks)
+    {
+      auto &args = chunk.get();
+      appender->Append(args, 0, args.size(), args.size());
+    }
     ArrowArray arr = appender->Finalize();
 
     // Copy from the Appender into the RecordBatch.
@@ -316,46 +606,162 @@ namespace duckdb
     AIRPORT_ARROW_ASSERT_OK_CONTAINER(
         writer_->WriteRecordBatch(*record_batch),
         this, "");
+  }
+
+  void AirportScalarFunctionLocalState::receive_result(ClientContext &context, idx_t count, Vector &result)
+  {
+    if (!deduplicate_arguments_ && !cache_function_)
+    {
+      receive_rows(context, count, result);
+      return;
+    }
 
-    scan_local_state_->Reset();
+    D_ASSERT(!deduplicated_.empty());
+    auto &batch = deduplicated_.front();
+    if (!batch.results)
+    {
+      batch.results = make_uniq<Vector>(result.GetType(), MaxValue<idx_t>(batch.distinct_rows, 1));
+      receive_rows(context, batch.distinct_rows, *batch.results);
+
+      if (cache_function_ && batch.distinct_rows > 0)
+      {
+        AirportScalarFunctionCache::Get().Insert(*cache_function_, batch.keys, *batch.results);
+      }
+    }
+
+    // Scatter the results of the distinct rows back to the rows of the chunk.
+    auto &entry = batch.chunks.front();
+    D_ASSERT(entry.count == count);
+    if (entry.cached_rows == 0)
+    {
+      result.Slice(*batch.results, entry.rows, count);
+    }
+    else
+    {
+      // Put the cached results and the ones from the server next to each
+      // other, then pick each row's result from one or the other.
+      Vector combined(result.GetType(), count + batch.distinct_rows);
+      VectorOperations::Copy(*entry.cached, combined, count, 0, 0);
+      VectorOperations::Copy(*batch.results, combined, batch.distinct_rows, 0, count);
+      SelectionVector rows(count);
+      for (idx_t row = 0; row < count; row++)
+      {
+        rows.set_index(row, entry.is_cached[row] ? row : count + entry.rows.get_index(row));
+      }
+      result.Slice(combined, rows, count);
+    }
+
+    batch.chunks.pop_front();
+    if (batch.chunks.empty())
+    {
+      deduplicated_.pop_front();
+    }
+  }
+
+  void AirportScalarFunctionLocalState::receive_rows(ClientContext &context, idx_t count, Vector &result)
+  {
+    // The server sends the results in the same order as the rows it is
+    // sent, but the batches it sends don't have to line up with the
+    // chunks, so the rows of a chunk can span batches.
+    unique_ptr<Vector> combined;
+    idx_t produced = 0;
+    while (produced < count)
+    {
+      if (!scan_local_state_->chunk ||
+          scan_local_state_->chunk_offset >= NumericCast<idx_t>(scan_local_state_->chunk->arrow_array.length))
+      {
+        scan_local_state_->Reset();
+        scan_local_state_->chunk = scan_local_state_->stream()->GetNextChunk();
+        if (!scan_local_state_->chunk || !scan_local_state_->chunk->arrow_array.release)
+        {
+          throw AirportFlightException(server_location(), descriptor(), "",
+                                       "Scalar function returned fewer rows than it was sent");
+        }
+      }
 
-    scan_local_state_->chunk = scan_local_state_->stream()->GetNextChunk();
+      auto output_size =
+          MinValue<idx_t>(count - produced,
+                          NumericCast<idx_t>(scan_local_state_->chunk->arrow_array.length) - scan_local_state_->chunk_offset);
 
-    auto output_size =
-        MinValue<idx_t>(STANDARD_VECTOR_SIZE, NumericCast<idx_t>(scan_local_state_->chunk->arrow_array.length) - scan_local_state_->chunk_offset);
+      DataChunk returning_data_chunk;
+      returning_data_chunk.Initialize(Allocator::Get(context),
+                                      scan_bind_data_->return_types(),
+                                      output_size);
 
-    DataChunk returning_data_chunk;
-    returning_data_chunk.Initialize(Allocator::Get(context),
-                                    scan_bind_data_->return_types(),
-                                    output_size);
+      returning_data_chunk.SetCardinality(output_size);
 
-    returning_data_chunk.SetCardinality(output_size);
+      ArrowTableFunction::ArrowToDuckDB(*(scan_local_state_.get()),
+                                        scan_bind_data_->arrow_table.GetColumns(),
+                                        returning_data_chunk,
+                                        0,
+                                        false);
+      scan_local_state_->chunk_offset += output_size;
 
-    ArrowTableFunction::ArrowToDuckDB(*(scan_local_state_.get()),
-                                      scan_bind_data_->arrow_table.GetColumns(),
-                                      returning_data_chunk,
-                                      0,
-                                      false);
+      returning_data_chunk.Verify();
 
-    returning_data_chunk.Verify();
+      if (produced == 0 && output_size == count)
+      {
+        result.Reference(returning_data_chunk.data[0]);
+        return;
+      }
 
-    result.Reference(returning_data_chunk.data[0]);
+      if (!combined)
+      {
+        combined = make_uniq<Vector>(result.GetType(), count);
+      }
+      VectorOperations::Copy(returning_data_chunk.data[0], *combined, output_size, 0, produced);
+      produced += output_size;
+    }
+
+    if (combined)
+    {
+      result.Reference(*combined);
+    }
   }
 
-  // Lets work on initializing the local state
-  unique_ptr<FunctionLocalState> AirportScalarFunctionInitLocalState(ExpressionState &state, const BoundFunctionExpression &expr, FunctionData *bind_data)
+  unique_ptr<AirportScalarFunctionLocalState> AirportScalarFunctionOpenStream(ClientContext &context, const BoundFunctionExpression &expr,
+                                                                              bool read_ahead)
   {
     auto &info = expr.function.function_info->Cast<AirportScalarFunctionInfo>();
-    auto &data = bind_data->Cast<AirportScalarFunctionBindData>();
+    auto &data = expr.bind_info->Cast<AirportScalarFunctionBindData>();
 
-    auto &transaction = AirportTransaction::Get(state.GetContext(), info.catalog());
+    auto &transaction = AirportTransaction::Get(context, info.catalog());
+
+    shared_ptr<AirportScalarFunctionCache::Function> cache_function;
+    if (info.deterministic() && AirportScalarFunctionCache::Get().capacity() > 0)
+    {
+      vector<LogicalType> argument_types;
+      for (auto &argument : expr.children)
+      {
+        argument_types.push_back(argument->return_type);
+      }
+      cache_function = AirportScalarFunctionCache::Get().GetFunction(info.server_location(),
+                                                                     info.function_name(),
+                                                                     info.function_version(),
+                                                                     argument_types,
+                                                                     expr.return_type);
+    }
+
+    // The function belongs to an attached database, so use its clients.
+    // The local state keeps the lease for as long as its exchange is open.
+    auto flight_client = AirportAPI::FlightClientForLocation(*info.catalog().Cast<AirportCatalog>().attach_parameters());
 
     return make_uniq<AirportScalarFunctionLocalState>(
-        state.GetContext(),
+        context,
+        std::move(flight_client),
         info,
         info.output_schema(),
         // Use this schema that should have the proper types for the any columns.
         data.input_schema(),
-        transaction.identifier());
+        transaction.identifier(),
+        read_ahead,
+        info.deduplicate_arguments(),
+        cache_function);
+  }
+
+  // Lets work on initializing the local state
+  unique_ptr<FunctionLocalState> AirportScalarFunctionInitLocalState(ExpressionState &state, const BoundFunctionExpression &expr, FunctionData *bind_data)
+  {
+    return AirportScalarFunctionOpenStream(state.GetContext(), expr);
   }
 }
\ No newline at end of file
@@ -0,0 +1,379 @@
+#include "duckdb.hpp"
+#include "airport_extension.hpp"
+#include "airport_scalar_function_cache.hpp"
+
+namespace duckdb
+{
+  AirportScalarFunctionCache &AirportScalarFunctionCache::Get()
+  {
+    static AirportScalarFunctionCache cache;
+    return cache;
+  }
+
+  shared_ptr<AirportScalarFunctionCache::Function> AirportScalarFunctionCache::GetFunction(const string &server_location,
+                                                                                         const string &name,
+                                                                                         const string &version,
+                                                                                         const vector<LogicalType> &argument_types,
+                                                                                         const LogicalType &return_type)
+  {
+    // The parts are length prefixed so that they can't run into each other.
+    string key;
+    auto add_part = [&key](const string &part)
+    {
+      key += to_string(part.size()) + ":" + part;
+    };
+    add_part(server_location);
+    add_part(name);
+    add_part(version);
+    for (auto &type : argument_types)
+    {
+      add_part(type.ToString());
+    }
+    add_part(return_type.ToString());
+    // The arguments come right after the key.
+    key += "|";
+
+    lock_guard<mutex> guard(lock_);
+    auto &function = functions_[key];
+    if (!function)
+    {
+      function = make_shared_ptr<Function>();
+      function->server_location = server_location;
+      function->name = name;
+      function->version = version;
+      function->return_type = return_type;
+      function->key = key;
+    }
+    return function;
+  }
+
+  // Values are encoded as N when they are NULL, otherwise as V followed by
+  // their bytes, strings have their length before them. The types of the
+  // function are part of its key so the values can't run into each other.
+  template <class T>
+  static void AirportEncodeFixed(UnifiedVectorFormat &format, idx_t count, vector<string> &encoded)
+  {
+    auto data = UnifiedVectorFormat::GetData<T>(format);
+    for (idx_t row = 0; row < count; row++)
+    {
+      auto idx = format.sel->get_index(row);
+      if (!format.validity.RowIsValid(idx))
+      {
+        encoded[row] += 'N';
+        continue;
+      }
+      encoded[row] += 'V';
+      encoded[row].append(const_char_ptr_cast(&data[idx]), sizeof(T));
+    }
+  }
+
+  static void AirportEncodeStrings(UnifiedVectorFormat &format, idx_t count, vector<string> &encoded)
+  {
+    auto data = UnifiedVectorFormat::GetData<string_t>(format);
+    for (idx_t row = 0; row < count; row++)
+    {
+      auto idx = format.sel->get_index(row);
+      if (!format.validity.RowIsValid(idx))
+      {
+        encoded[row] += 'N';
+        continue;
+      }
+      const uint32_t length = data[idx].GetSize();
+      encoded[row] += 'V';
+      encoded[row].append(const_char_ptr_cast(&length), sizeof(length));
+      encoded[row].append(data[idx].GetData(), length);
+    }
+  }
+
+  // Append the encoding of every row of a vector, returns false if its
+  // type has no encoding.
+  static bool AirportEncodeVector(Vector &input, idx_t count, vector<string> &encoded)
+  {
+    UnifiedVectorFormat format;
+    input.ToUnifiedFormat(count, format);
+    switch (input.GetType().InternalType())
+    {
+    case PhysicalType::BOOL:
+    case PhysicalType::INT8:
+      AirportEncodeFixed<int8_t>(format, count, encoded);
+      return true;
+    case PhysicalType::INT16:
+      AirportEncodeFixed<int16_t>(format, count, encoded);
+      return true;
+    case PhysicalType::INT32:
+      AirportEncodeFixed<int32_t>(format, count, encoded);
+      return true;
+    case PhysicalType::INT64:
+      AirportEncodeFixed<int64_t>(format, count, encoded);
+      return true;
+    case PhysicalType::INT128:
+      AirportEncodeFixed<hugeint_t>(format, count, encoded);
+      return true;
+    case PhysicalType::UINT8:
+      AirportEncodeFixed<uint8_t>(format, count, encoded);
+      return true;
+    case PhysicalType::UINT16:
+      AirportEncodeFixed<uint16_t>(format, count, encoded);
+      return true;
+    case PhysicalType::UINT32:
+      AirportEncodeFixed<uint32_t>(format, count, encoded);
+      return true;
+    case PhysicalType::UINT64:
+      AirportEncodeFixed<uint64_t>(format, count, encoded);
+      return true;
+    case PhysicalType::UINT128:
+      AirportEncodeFixed<uhugeint_t>(format, count, encoded);
+      return true;
+    case PhysicalType::FLOAT:
+      AirportEncodeFixed<float>(format, count, encoded);
+      return true;
+    case PhysicalType::DOUBLE:
+      AirportEncodeFixed<double>(format, count, encoded);
+      return true;
+    case PhysicalType::INTERVAL:
+      AirportEncodeFixed<interval_t>(format, count, encoded);
+      return true;
+    case PhysicalType::VARCHAR:
+      AirportEncodeStrings(format, count, encoded);
+      return true;
+    default:
+      return false;
+    }
+  }
+
+  template <class T>
+  static void AirportDecodeFixed(const string &encoded, Vector &result, idx_t row)
+  {
+    D_ASSERT(encoded.size() == 1 + sizeof(T));
+    memcpy(&FlatVector::GetData<T>(result)[row], encoded.data() + 1, sizeof(T));
+  }
+
+  static void AirportDecodeValue(const string &encoded, Vector &result, idx_t row)
+  {
+    D_ASSERT(!encoded.empty());
+    if (encoded[0] == 'N')
+    {
+      FlatVector::SetNull(result, row, true);
+      return;
+    }
+    FlatVector::SetNull(result, row, false);
+    switch (result.GetType().InternalType())
+    {
+    case PhysicalType::BOOL:
+    case PhysicalType::INT8:
+      AirportDecodeFixed<int8_t>(encoded, result, row);
+      break;
+    case PhysicalType::INT16:
+      AirportDecodeFixed<int16_t>(encoded, result, row);
+      break;
+    case PhysicalType::INT32:
+      AirportDecodeFixed<int32_t>(encoded, result, row);
+      break;
+    case PhysicalType::INT64:
+      AirportDecodeFixed<int64_t>(encoded, result, row);
+      break;
+    case PhysicalType::INT128:
+      AirportDecodeFixed<hugeint_t>(encoded, result, row);
+      break;
+    case PhysicalType::UINT8:
+      AirportDecodeFixed<uint8_t>(encoded, result, row);
+      break;
+    case PhysicalType::UINT16:
+      AirportDecodeFixed<uint16_t>(encoded, result, row);
+      break;
+    case PhysicalType::UINT32:
+      AirportDecodeFixed<uint32_t>(encoded, result, row);
+      break;
+    case PhysicalType::UINT64:
+      AirportDecodeFixed<uint64_t>(encoded, result, row);
+      break;
+    case PhysicalType::UINT128:
+      AirportDecodeFixed<uhugeint_t>(encoded, result, row);
+      break;
+    case PhysicalType::FLOAT:
+      AirportDecodeFixed<float>(encoded, result, row);
+      break;
+    case PhysicalType::DOUBLE:
+      AirportDecodeFixed<double>(encoded, result, row);
+      break;
+    case PhysicalType::INTERVAL:
+      AirportDecodeFixed<interval_t>(encoded, result, row);
+      break;
+    case PhysicalType::VARCHAR:
+    {
+      uint32_t length;
+      memcpy(&length, encoded.data() + 1, sizeof(length));
+      FlatVector::GetData<string_t>(result)[row] =
+          StringVector::AddStringOrBlob(result, encoded.data() + 1 + sizeof(length), length);
+      break;
+    }
+    default:
+      throw InternalException("Airport scalar function cache can't decode a result of type %s", result.GetType().ToString());
+    }
+  }
+
+  void AirportScalarFunctionCache::ArgumentsKeys(DataChunk &chunk, vector<string> &keys)
+  {
+    keys.assign(chunk.size(), string());
+    for (idx_t col = 0; col < chunk.ColumnCount(); col++)
+    {
+      if (AirportEncodeVector(chunk.data[col], chunk.size(), keys))
+      {
+        continue;
+      }
+      // Nested types have no fixed layout, so use the text of their values.
+      for (idx_t row = 0; row < chunk.size(); row++)
+      {
+        auto value = chunk.GetValue(col, row);
+        if (value.IsNull())
+        {
+          keys[row] += 'N';
+          continue;
+        }
+        auto str = value.ToString();
+        keys[row] += to_string(str.size()) + ":" + str;
+      }
+    }
+  }
+
+  idx_t AirportScalarFunctionCache::Lookup(Function &function, const vector<string> &arguments, Vector &results, vector<bool> &found)
+  {
+    D_ASSERT(results.GetVectorType() == VectorType::FLAT_VECTOR);
+    found.assign(arguments.size(), false);
+    const bool nested = function.return_type.IsNested();
+
+    idx_t hits = 0;
+    lock_guard<mutex> guard(lock_);
+    for (idx_t i = 0; i < arguments.size(); i++)
+    {
+      auto entry = index_.find(function.key + arguments[i]);
+      if (entry == index_.end())
+      {
+        FlatVector::SetNull(results, i, true);
+        continue;
+      }
+      entries_.splice(entries_.begin(), entries_, entry->second);
+      if (nested)
+      {
+        results.SetValue(i, entry->second->nested_result);
+      }
+      else
+      {
+        AirportDecodeValue(entry->second->result, results, i);
+      }
+      found[i] = true;
+      hits++;
+    }
+    function.hits += hits;
+    function.misses += arguments.size() - hits;
+    return hits;
+  }
+
+  void AirportScalarFunctionCache::Insert(Function &function, const vector<string> &arguments, Vector &results)
+  {
+    const bool nested = function.return_type.IsNested();
+    vector<string> encoded(arguments.size());
+    if (!nested)
+    {
+      AirportEncodeVector(results, arguments.size(), encoded);
+    }
+
+    lock_guard<mutex> guard(lock_);
+    for (idx_t i = 0; i < arguments.size(); i++)
+    {
+      auto key = function.key + arguments[i];
+      auto existing = index_.find(key);
+      if (existing != index_.end())
+      {
+        // Another thread got there first.
+        entries_.splice(entries_.begin(), entries_, existing->second);
+        continue;
+      }
+      entries_.push_front(Entry{key, std::move(encoded[i]), nested ? results.GetValue(i) : Value(), &function});
+      index_[std::move(key)] = entries_.begin();
+      function.entries++;
+    }
+    Evict();
+  }
+
+  void AirportScalarFunctionCache::Evict()
+  {
+    while (entries_.size() > capacity_)
+    {
+      auto &last = entries_.back();
+      last.function->entries--;
+      index_.erase(last.key);
+      entries_.pop_back();
+    }
+  }
+
+  void AirportScalarFunctionCache::SetCapacityOnSetting(ClientContext &context, SetScope scope, Value &parameter)
+  {
+    auto &cache = Get();
+    lock_guard<mutex> guard(cache.lock_);
+    cache.capacity_ = parameter.IsNull() ? AIRPORT_DEFAULT_SCALAR_FUNCTION_CACHE_ENTRIES : parameter.GetValue<uint64_t>();
+    cache.Evict();
+  }
+
+  vector<AirportScalarFunctionCache::Function> AirportScalarFunctionCache::Functions()
+  {
+    vector<Function> result;
+    lock_guard<mutex> guard(lock_);
+    for (auto &entry : functions_)
+    {
+      result.push_back(*entry.second);
+    }
+    return result;
+  }
+
+  struct AirportScalarFunctionCacheFunctionData : public TableFunctionData
+  {
+    vector<AirportScalarFunctionCache::Function> functions;
+    idx_t offset = 0;
+  };
+
+  static unique_ptr<FunctionData> AirportScalarFunctionCacheBind(ClientContext &context, TableFunctionBindInput &input,
+                                                                 vector<LogicalType> &return_types, vector<string> &names)
+  {
+    names.emplace_back("location");
+    return_types.emplace_back(LogicalType::VARCHAR);
+    names.emplace_back("function_name");
+    return_types.emplace_back(LogicalType::VARCHAR);
+    names.emplace_back("function_version");
+    return_types.emplace_back(LogicalType::VARCHAR);
+    names.emplace_back("entries");
+    return_types.emplace_back(LogicalType::BIGINT);
+    names.emplace_back("hits");
+    return_types.emplace_back(LogicalType::BIGINT);
+    names.emplace_back("misses");
+    return_types.emplace_back(LogicalType::BIGINT);
+
+    auto result = make_uniq<AirportScalarFunctionCacheFunctionData>();
+    result->functions = AirportScalarFunctionCache::Get().Functions();
+    return result;
+  }
+
+  static void AirportScalarFunctionCacheFunction(ClientContext &context, TableFunctionInput &data_p, DataChunk &output)
+  {
+    auto &data = data_p.bind_data->CastNoConst<AirportScalarFunctionCacheFunctionData>();
+    idx_t count = 0;
+    while (data.offset < data.functions.size() && count < STANDARD_VECTOR_SIZE)
+    {
+      auto &function = data.functions[data.offset++];
+      output.SetValue(0, count, Value(function.server_location));
+      output.SetValue(1, count, Value(function.name));
+      output.SetValue(2, count, Value(function.version));
+      output.SetValue(3, count, Value::BIGINT(function.entries));
+      output.SetValue(4, count, Value::BIGINT(function.hits));
+      output.SetValue(5, count, Value::BIGINT(function.misses));
+      count++;
+    }
+    output.SetCardinality(count);
+  }
+
+  void AirportAddScalarFunctionCacheFunction(ExtensionLoader &loader)
+  {
+    TableFunction cache_function("airport_scalar_function_cache", {}, AirportScalarFunctionCacheFunction, AirportScalarFunctionCacheBind);
+    loader.RegisterFunction(cache_function);
+  }
+}
@@ -0,0 +1,425 @@
+#include "duckdb.hpp"
+#include "duckdb/execution/expression_executor.hpp"
+#include "duckdb/execution/physical_plan_generator.hpp"
+#include "duckdb/optimizer/optimizer.hpp"
+#include "duckdb/parallel/pipeline.hpp"
+#include "duckdb/planner/binder.hpp"
+#include "duckdb/planner/column_binding_map.hpp"
+#include "duckdb/planner/expression_iterator.hpp"
+#include "duckdb/planner/expression/bound_cast_expression.hpp"
+#include "duckdb/planner/expression/bound_columnref_expression.hpp"
+#include "duckdb/planner/expression/bound_function_expression.hpp"
+#include "duckdb/planner/operator/logical_projection.hpp"
+#include "airport_scalar_function.hpp"
+#include "airport_scalar_function_pipeline.hpp"
+#include "airport_settings.hpp"
+#include <deque>
+
+namespace duckdb
+{
+  LogicalAirportScalarFunctionPipeline::LogicalAirportScalarFunctionPipeline(idx_t table_index,
+                                                                             vector<unique_ptr<Expression>> functions,
+                                                                             idx_t window,
+                                                                             idx_t batch_rows)
+      : LogicalExtensionOperator(std::move(functions)), table_index(table_index), window(window), batch_rows(batch_rows)
+  {
+  }
+
+  vector<ColumnBinding> LogicalAirportScalarFunctionPipeline::GetColumnBindings()
+  {
+    auto child_bindings = children[0]->GetColumnBindings();
+    vector<ColumnBinding> result;
+    for (auto column : projection_map)
+    {
+      result.push_back(child_bindings[column]);
+    }
+    for (idx_t i = 0; i < expressions.size(); i++)
+    {
+      result.emplace_back(table_index, i);
+    }
+    return result;
+  }
+
+  void LogicalAirportScalarFunctionPipeline::ResolveTypes()
+  {
+    types.clear();
+    for (auto column : projection_map)
+    {
+      types.push_back(children[0]->types[column]);
+    }
+    for (auto &expr : expressions)
+    {
+      types.push_back(expr->return_type);
+    }
+  }
+
+  PhysicalOperator &LogicalAirportScalarFunctionPipeline::CreatePlan(ClientContext &context, PhysicalPlanGenerator &planner)
+  {
+    auto &child = planner.CreatePlan(*children[0]);
+    auto &pipeline = planner.Make<AirportScalarFunctionPipeline>(types, std::move(expressions), window, batch_rows,
+                                                                    projection_map, estimated_cardinality);
+    pipeline.children.push_back(child);
+    return pipeline;
+  }
+
+  AirportScalarFunctionPipeline::AirportScalarFunctionPipeline(PhysicalPlan &physical_plan,
+                                                               vector<LogicalType> types,
+                                                               vector<unique_ptr<Expression>> functions_p,
+                                                               idx_t window,
+                                                               idx_t batch_rows,
+                                                               vector<idx_t> projection_map_p,
+                                                               idx_t estimated_cardinality)
+      : PhysicalOperator(physical_plan, PhysicalOperatorType::EXTENSION, std::move(types), estimated_cardinality),
+        functions(std::move(functions_p)), window(window), batch_rows(batch_rows), projection_map(std::move(projection_map_p))
+  {
+  }
+
+  // The chunks that are sent to the server as a single batch.
+  struct AirportScalarFunctionPipelineBatch
+  {
+    // The number of rows of each input chunk.
+    std::deque<idx_t> counts;
+    // The passed through columns of the input chunks, needed again once
+    // the results arrive. Empty when no columns are passed through.
+    std::deque<unique_ptr<DataChunk>> inputs;
+    // The arguments of each function for each of the input chunks.
+    vector<vector<unique_ptr<DataChunk>>> arguments;
+    idx_t rows = 0;
+  };
+
+  class AirportScalarFunctionPipelineState : public OperatorState
+  {
+  public:
+    // Decided with the first chunk, once the pipeline is known.
+    bool initialized = false;
+    idx_t window = 1;
+    idx_t batch_rows = 0;
+
+    // The stream of each function, opened with the first chunk.
+    vector<unique_ptr<AirportScalarFunctionLocalState>> streams;
+    // The arguments of each function.
+    vector<unique_ptr<ExpressionExecutor>> executors;
+    vector<vector<LogicalType>> argument_types;
+
+    // The types of the columns of the child that are passed through.
+    vector<LogicalType> held_types;
+    // References the passed through columns of an input chunk.
+    DataChunk passed_through;
+
+    // The chunks collected for the next batch.
+    AirportScalarFunctionPipelineBatch pending;
+
+    // The batches that were sent whose results haven't all been read.
+    std::deque<AirportScalarFunctionPipelineBatch> in_flight;
+  };
+
+  unique_ptr<OperatorState> AirportScalarFunctionPipeline::GetOperatorState(ExecutionContext &context) const
+  {
+    auto result = make_uniq<AirportScalarFunctionPipelineState>();
+    for (auto &function : functions)
+    {
+      auto &function_expr = function->Cast<BoundFunctionExpression>();
+      auto executor = make_uniq<ExpressionExecutor>(context.client);
+      vector<LogicalType> argument_types;
+      for (auto &argument : function_expr.children)
+      {
+        executor->AddExpression(*argument);
+        argument_types.push_back(argument->return_type);
+      }
+
+      result->executors.push_back(std::move(executor));
+      result->argument_types.push_back(std::move(argument_types));
+    }
+    result->pending.arguments.resize(functions.size());
+    for (idx_t i = 0; i < projection_map.size(); i++)
+    {
+      result->held_types.push_back(types[i]);
+    }
+    if (!result->held_types.empty())
+    {
+      result->passed_through.InitializeEmpty(result->held_types);
+    }
+    return std::move(result);
+  }
+
+  // Send the pending chunks to the server as one batch for each function.
+  static void AirportScalarFunctionPipelineSend(ExecutionContext &context, AirportScalarFunctionPipelineState &state)
+  {
+    auto &pending = state.pending;
+    for (idx_t i = 0; i < state.streams.size(); i++)
+    {
+      vector<reference<DataChunk>> chunks;
+      for (auto &arguments : pending.arguments[i])
+      {
+        chunks.push_back(*arguments);
+      }
+      state.streams[i]->send_chunks(context.client, chunks);
+      // The arguments aren't needed once they are sent.
+      pending.arguments[i].clear();
+    }
+
+    state.in_flight.push_back(std::move(pending));
+    state.pending = AirportScalarFunctionPipelineBatch();
+    state.pending.arguments.resize(state.streams.size());
+  }
+
+  // Output the oldest chunk that was sent along with the results of the
+  // functions for it.
+  static void AirportScalarFunctionPipelineOutput(ExecutionContext &context,
+                                                  AirportScalarFunctionPipelineState &state,
+                                                  DataChunk &chunk)
+  {
+    auto &batch = state.in_flight.front();
+    const auto count = batch.counts.front();
+    batch.counts.pop_front();
+    unique_ptr<DataChunk> input;
+    if (!batch.inputs.empty())
+    {
+      input = std::move(batch.inputs.front());
+      batch.inputs.pop_front();
+    }
+    if (batch.counts.empty())
+    {
+      state.in_flight.pop_front();
+    }
+
+    const auto input_columns = state.held_types.size();
+    for (idx_t col = 0; col < input_columns; col++)
+    {
+      chunk.data[col].Reference(input->data[col]);
+    }
+    for (idx_t i = 0; i < state.streams.size(); i++)
+    {
+      state.streams[i]->receive_result(context.client, count, chunk.data[input_columns + i]);
+    }
+    chunk.SetCardinality(count);
+  }
+
+  OperatorResultType AirportScalarFunctionPipeline::Execute(ExecutionContext &context, DataChunk &input, DataChunk &chunk,
+                                                            GlobalOperatorState &gstate, OperatorState &state_p) const
+  {
+    auto &state = state_p.Cast<AirportScalarFunctionPipelineState>();
+
+    if (!state.initialized)
+    {
+      state.initialized = true;
+      state.window = window;
+      state.batch_rows = batch_rows;
+      // Like CachingPhysicalOperator, chunks can only be held back when the
+      // sink doesn't depend on the batch index or the order of the rows it
+      // gets. Otherwise every chunk is sent and its results read before
+      // the next one.
+      if (!context.pipeline || !context.pipeline->GetSink() ||
+          context.pipeline->GetSink()->RequiresBatchIndex() ||
+          context.pipeline->IsOrderDependent())
+      {
+        state.window = 1;
+        state.batch_rows = 0;
+      }
+    }
+
+    if (input.size() > 0)
+    {
+      if (state.streams.empty())
+      {
+        for (auto &function : functions)
+        {
+          // With chunks in flight the results are read as they arrive.
+          // A server that has to wait for its results to be read would
+          // stop reading arguments, and the next send would wait on it.
+          state.streams.push_back(AirportScalarFunctionOpenStream(context.client, function->Cast<BoundFunctionExpression>(),
+                                                                  state.window > 1));
+        }
+      }
+
+      for (idx_t i = 0; i < functions.size(); i++)
+      {
+        auto arguments = make_uniq<DataChunk>();
+        arguments->Initialize(Allocator::Get(context.client), state.argument_types[i]);
+        state.executors[i]->Execute(input, *arguments);
+        state.pending.arguments[i].push_back(std::move(arguments));
+      }
+
+      // Only the columns that are passed through are held, when there are
+      // none only the number of rows is kept.
+      if (!projection_map.empty())
+      {
+        for (idx_t i = 0; i < projection_map.size(); i++)
+        {
+          state.passed_through.data[i].Reference(input.data[projection_map[i]]);
+        }
+        state.passed_through.SetCardinality(input.size());
+        auto held = make_uniq<DataChunk>();
+        held->Initialize(Allocator::Get(context.client), state.held_types);
+        state.passed_through.Copy(*held);
+        state.pending.inputs.push_back(std::move(held));
+      }
+      state.pending.counts.push_back(input.size());
+      state.pending.rows += input.size();
+
+      if (state.pending.rows >= state.batch_rows)
+      {
+        AirportScalarFunctionPipelineSend(context, state);
+      }
+    }
+
+    if (!state.in_flight.empty() && state.in_flight.size() >= state.window)
+    {
+      AirportScalarFunctionPipelineOutput(context, state, chunk);
+    }
+    return OperatorResultType::NEED_MORE_INPUT;
+  }
+
+  OperatorFinalizeResultType AirportScalarFunctionPipeline::FinalExecute(ExecutionContext &context, DataChunk &chunk,
+                                                                         GlobalOperatorState &gstate, OperatorState &state_p) const
+  {
+    auto &state = state_p.Cast<AirportScalarFunctionPipelineState>();
+    if (!state.pending.counts.empty())
+    {
+      AirportScalarFunctionPipelineSend(context, state);
+    }
+    if (!state.in_flight.empty())
+    {
+      AirportScalarFunctionPipelineOutput(context, state, chunk);
+    }
+    return state.in_flight.empty() ? OperatorFinalizeResultType::FINISHED : OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
+  }
+
+  string AirportScalarFunctionPipeline::GetName() const
+  {
+    return "AIRPORT_SCALAR_FUNCTION_PIPELINE";
+  }
+
+  InsertionOrderPreservingMap<string> AirportScalarFunctionPipeline::ParamsToString() const
+  {
+    InsertionOrderPreservingMap<string> result;
+    string function_names;
+    for (auto &function : functions)
+    {
+      if (!function_names.empty())
+      {
+        function_names += "\n";
+      }
+      function_names += function->GetName();
+    }
+    result["Functions"] = function_names;
+    result["Window"] = to_string(window);
+    if (batch_rows > 1)
+    {
+      result["Batch Rows"] = to_string(batch_rows);
+    }
+    return result;
+  }
+
+  static idx_t AirportScalarFunctionBatchRows(const Expression &expr)
+  {
+    auto &function_expr = expr.Cast<BoundFunctionExpression>();
+    auto batch_rows = function_expr.function.function_info->Cast<AirportScalarFunctionInfo>().preferred_batch_rows();
+    // Don't hold more than a reasonable amount of rows per function.
+    return MinValue<idx_t>(batch_rows, STANDARD_VECTOR_SIZE * 512);
+  }
+
+  static bool AirportIsRemoteScalarFunction(const Expression &expr, idx_t window)
+  {
+    if (expr.GetExpressionClass() != ExpressionClass::BOUND_FUNCTION)
+    {
+      return false;
+    }
+    auto &function_expr = expr.Cast<BoundFunctionExpression>();
+    // Functions without arguments are left alone, there is nothing to
+    // send for them.
+    if (function_expr.function.init_local_state != AirportScalarFunctionInitLocalState ||
+        function_expr.children.empty())
+    {
+      return false;
+    }
+    // Functions are only worth moving when chunks are kept in flight or
+    // the server wants bigger batches than a chunk.
+    return window > 1 || AirportScalarFunctionBatchRows(expr) > STANDARD_VECTOR_SIZE;
+  }
+
+  static void AirportPipelineProjection(OptimizerExtensionInput &input, LogicalProjection &projection, idx_t window)
+  {
+    vector<unique_ptr<Expression>> functions;
+    idx_t table_index = DConstants::INVALID_INDEX;
+    // The functions of a pipeline share the batches, so the largest
+    // preferred size is used.
+    idx_t batch_rows = 0;
+
+    for (auto &expr : projection.expressions)
+    {
+      // The result of the function is often cast to the type of a column.
+      auto &target = expr->GetExpressionClass() == ExpressionClass::BOUND_CAST ? expr->Cast<BoundCastExpression>().child : expr;
+      if (!AirportIsRemoteScalarFunction(*target, window))
+      {
+        continue;
+      }
+      if (functions.empty())
+      {
+        table_index = input.optimizer.binder.GenerateTableIndex();
+      }
+      auto column_ref = make_uniq<BoundColumnRefExpression>(target->alias,
+                                                            target->return_type,
+                                                            ColumnBinding(table_index, functions.size()));
+      batch_rows = MaxValue(batch_rows, AirportScalarFunctionBatchRows(*target));
+      functions.push_back(std::move(target));
+      target = std::move(column_ref);
+    }
+
+    if (functions.empty())
+    {
+      return;
+    }
+
+    // The columns of the child that the projection still uses, the rest
+    // don't need to be held while the functions run.
+    column_binding_set_t referenced;
+    for (auto &expr : projection.expressions)
+    {
+      ExpressionIterator::EnumerateExpression(expr, [&referenced](Expression &child)
+                                              {
+                                                if (child.GetExpressionClass() == ExpressionClass::BOUND_COLUMN_REF)
+                                                {
+                                                  referenced.insert(child.Cast<BoundColumnRefExpression>().binding);
+                                                }
+                                              });
+    }
+
+    auto pipeline = make_uniq<LogicalAirportScalarFunctionPipeline>(table_index, std::move(functions), MaxValue<idx_t>(window, 1), batch_rows);
+    auto child_bindings = projection.children[0]->GetColumnBindings();
+    for (idx_t i = 0; i < child_bindings.size(); i++)
+    {
+      if (referenced.find(child_bindings[i]) != referenced.end())
+      {
+        pipeline->projection_map.push_back(i);
+      }
+    }
+    pipeline->has_estimated_cardinality = projection.children[0]->has_estimated_cardinality;
+    pipeline->estimated_cardinality = projection.children[0]->estimated_cardinality;
+    pipeline->children.push_back(std::move(projection.children[0]));
+    pipeline->ResolveOperatorTypes();
+    projection.children[0] = std::move(pipeline);
+  }
+
+  static void AirportPipelineScalarFunctions(OptimizerExtensionInput &input, unique_ptr<LogicalOperator> &op, idx_t window, bool rewrite)
+  {
+    for (auto &child : op->children)
+    {
+      // The projection below an UPDATE holds the new values of the columns,
+      // the parameterized update needs to find it right above the scan.
+      AirportPipelineScalarFunctions(input, child, window, op->type != LogicalOperatorType::LOGICAL_UPDATE);
+    }
+
+    if (!rewrite || op->type != LogicalOperatorType::LOGICAL_PROJECTION)
+    {
+      return;
+    }
+    AirportPipelineProjection(input, op->Cast<LogicalProjection>(), window);
+  }
+
+  void AirportPipelineScalarFunctions(OptimizerExtensionInput &input, unique_ptr<LogicalOperator> &plan)
+  {
+    const auto window = AirportGetUBigIntSetting(input.context, "airport_scalar_function_window", 4);
+    AirportPipelineScalarFunctions(input, plan, window, true);
+  }
+}
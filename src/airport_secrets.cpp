@@ -3,6 +3,7 @@
 
 #include "duckdb/main/secret/secret_manager.hpp"
 #include "airport_secrets.hpp"
+#include "airport_flight_client_pool.hpp"
 
 namespace duckdb
 {
@@ -75,4 +76,42 @@ namespace duckdb
     }
     return "";
   }
+
+  void AirportFlightClientOptionsFromSecret(ClientContext &context, const string &server_location, const string &secret_name, AirportFlightClientOptions &options)
+  {
+    unique_ptr<SecretEntry> named_secret;
+    const BaseSecret *secret = nullptr;
+    SecretMatch secret_match;
+    if (!secret_name.empty())
+    {
+      named_secret = AirportGetSecretByName(context, secret_name);
+      if (named_secret)
+      {
+        secret = named_secret->secret.get();
+      }
+    }
+    else
+    {
+      secret_match = AirportGetSecretByPath(context, server_location);
+      if (secret_match.HasMatch())
+      {
+        secret = secret_match.secret_entry->secret.get();
+      }
+    }
+
+    if (!secret)
+    {
+      return;
+    }
+
+    const auto &kv_secret = dynamic_cast<const KeyValueSecret &>(*secret);
+    for (auto &name : AirportFlightClientOptions::Names())
+    {
+      Value input_val = kv_secret.TryGetValue(name);
+      if (!input_val.IsNull())
+      {
+        options.Set(name, input_val);
+      }
+    }
+  }
 }
\ No newline at end of file
@@ -0,0 +1,204 @@
+#include "duckdb.hpp"
+#include "duckdb/main/config.hpp"
+#include "duckdb/parallel/task_scheduler.hpp"
+#include "duckdb/storage/buffer_manager.hpp"
+#include "airport_flight_client_pool.hpp"
+#include "airport_scalar_function_cache.hpp"
+#include "airport_settings.hpp"
+#include <arrow/util/compression.h>
+#include <arrow/util/thread_pool.h>
+
+namespace duckdb
+{
+  static constexpr idx_t AIRPORT_DEFAULT_SCAN_PREFETCH_BYTES = 64ULL * 1024 * 1024;
+  static constexpr idx_t AIRPORT_DEFAULT_WRITE_BATCH_ROWS = 1024ULL * 1024;
+  static constexpr idx_t AIRPORT_DEFAULT_WRITE_BATCH_BYTES = 64ULL * 1024 * 1024;
+
+  void AirportAddSettings(ExtensionLoader &loader)
+  {
+    auto &config = DBConfig::GetConfig(loader.GetDatabaseInstance());
+
+    config.AddExtensionOption("airport_scan_prefetch_bytes",
+                              "The maximum number of bytes of record batches each Airport scan thread reads ahead from a DoGet stream (0 disables prefetching)",
+                              LogicalType::UBIGINT,
+                              Value::UBIGINT(AIRPORT_DEFAULT_SCAN_PREFETCH_BYTES));
+
+    config.AddExtensionOption("airport_scan_share_endpoint_streams",
+                              "When a flight has fewer endpoints than threads, let every scan thread convert record batches from the same endpoint stream",
+                              LogicalType::BOOLEAN,
+                              Value::BOOLEAN(true));
+
+    config.AddExtensionOption("airport_scan_prune_endpoints",
+                              "Skip the endpoints of a flight whose column statistics (in the endpoint's app_metadata) show they can't match the query's filters",
+                              LogicalType::BOOLEAN,
+                              Value::BOOLEAN(true));
+
+    config.AddExtensionOption("airport_flight_channels_per_location",
+                              "The number of gRPC channels (connections) opened to each Flight server location, calls are spread across them",
+                              LogicalType::UBIGINT,
+                              Value::UBIGINT(AIRPORT_DEFAULT_FLIGHT_CHANNELS_PER_LOCATION),
+                              AirportCheckFlightChannelsPerLocation);
+
+    config.AddExtensionOption("airport_ipc_compression",
+                              "Compress the bodies of record batches exchanged with Flight servers: none, lz4_frame, zstd or adaptive (lz4_frame, but batches that don't shrink by a quarter are sent uncompressed)",
+                              LogicalType::VARCHAR,
+                              Value("none"));
+
+    config.AddExtensionOption("airport_write_batch_rows",
+                              "The maximum number of rows an INSERT, UPDATE or DELETE without RETURNING collects into each record batch it sends (0 sends every chunk on its own)",
+                              LogicalType::UBIGINT,
+                              Value::UBIGINT(AIRPORT_DEFAULT_WRITE_BATCH_ROWS));
+
+    config.AddExtensionOption("airport_write_batch_bytes",
+                              "The maximum number of bytes an INSERT, UPDATE or DELETE without RETURNING collects into each record batch it sends (0 sends every chunk on its own)",
+                              LogicalType::UBIGINT,
+                              Value::UBIGINT(AIRPORT_DEFAULT_WRITE_BATCH_BYTES));
+
+    config.AddExtensionOption("airport_parallel_exchange",
+                              "Let every thread of an INSERT, UPDATE or DELETE open its own DoExchange stream when the table's server supports it",
+                              LogicalType::BOOLEAN,
+                              Value::BOOLEAN(true));
+
+    config.AddExtensionOption("airport_scalar_function_window",
+                              "The number of chunks each thread sends to an Airport scalar function before waiting for the results of the oldest (1 waits for every chunk)",
+                              LogicalType::UBIGINT,
+                              Value::UBIGINT(4));
+
+    config.AddExtensionOption("airport_scalar_function_cache_entries",
+                              "The number of results of deterministic Airport scalar functions kept in a cache shared by all connections, setting it changes it for every connection (0 disables the cache)",
+                              LogicalType::UBIGINT,
+                              Value::UBIGINT(AIRPORT_DEFAULT_SCALAR_FUNCTION_CACHE_ENTRIES),
+                              AirportScalarFunctionCache::SetCapacityOnSetting);
+
+    config.AddExtensionOption("airport_write_behind",
+                              "Hold the rows of INSERTs in an explicit transaction and send them when it commits, the table is read or airport_write_batch_rows/bytes are reached",
+                              LogicalType::BOOLEAN,
+                              Value::BOOLEAN(false));
+
+    config.AddExtensionOption("airport_delete_rowid_ranges",
+                              "Send the row ids of a DELETE as sorted ranges when the table's server supports it",
+                              LogicalType::BOOLEAN,
+                              Value::BOOLEAN(true));
+
+    config.AddExtensionOption("airport_put_ingest",
+                              "Use DoPut for INSERT and CREATE TABLE AS without RETURNING when the table's server supports it",
+                              LogicalType::BOOLEAN,
+                              Value::BOOLEAN(true));
+
+    config.AddExtensionOption("airport_ingest_staging_uri",
+                              "A location (URI or path) the server can read where INSERT and CREATE TABLE AS stage Arrow IPC files for tables that support staged ingest, empty to send rows over Flight",
+                              LogicalType::VARCHAR,
+                              Value(""));
+
+    AirportAddFlightClientSettings(config);
+  }
+
+  idx_t AirportGetUBigIntSetting(ClientContext &context, const string &name, const idx_t default_value)
+  {
+    Value result;
+    if (!context.TryGetCurrentSetting(name, result) || result.IsNull())
+    {
+      return default_value;
+    }
+    return result.GetValue<uint64_t>();
+  }
+
+  bool AirportGetBooleanSetting(ClientContext &context, const string &name, const bool default_value)
+  {
+    Value result;
+    if (!context.TryGetCurrentSetting(name, result) || result.IsNull())
+    {
+      return default_value;
+    }
+    return BooleanValue::Get(result);
+  }
+
+  idx_t AirportScanPrefetchBytes(ClientContext &context)
+  {
+    auto requested = AirportGetUBigIntSetting(context, "airport_scan_prefetch_bytes", AIRPORT_DEFAULT_SCAN_PREFETCH_BYTES);
+    if (requested == 0)
+    {
+      return 0;
+    }
+
+    // Every scan thread has its own prefetch queue, so don't let all of the
+    // queues together use more than a quarter of the memory limit.
+    auto &buffer_manager = BufferManager::GetBufferManager(context);
+    auto threads = MaxValue<idx_t>(1, (idx_t)TaskScheduler::GetScheduler(context).NumberOfThreads());
+    auto per_thread_limit = buffer_manager.GetMaxMemory() / (threads * 4);
+
+    return MinValue<idx_t>(requested, per_thread_limit);
+  }
+
+  idx_t AirportWriteBatchRows(ClientContext &context)
+  {
+    return AirportGetUBigIntSetting(context, "airport_write_batch_rows", AIRPORT_DEFAULT_WRITE_BATCH_ROWS);
+  }
+
+  idx_t AirportWriteBatchBytes(ClientContext &context)
+  {
+    return AirportGetUBigIntSetting(context, "airport_write_batch_bytes", AIRPORT_DEFAULT_WRITE_BATCH_BYTES);
+  }
+
+  // Arrow decompresses the columns of a batch on its own thread pool, which
+  // is sized by the number of cores. Keep it to DuckDB's threads setting so
+  // the two pools together don't oversubscribe the machine. The pool is
+  // shared by the whole process, so the last database to use it sets it.
+  static void AirportLimitArrowCpuThreads(ClientContext &context)
+  {
+    const auto threads = MaxValue<int>(1, (int)TaskScheduler::GetScheduler(context).NumberOfThreads());
+    if (arrow::GetCpuThreadPoolCapacity() != threads)
+    {
+      // Failing to resize only leaves the pool at its old size.
+      (void)arrow::SetCpuThreadPoolCapacity(threads);
+    }
+  }
+
+  void AirportUseIpcCompression(ClientContext &context, arrow::flight::FlightCallOptions &call_options)
+  {
+    Value setting;
+    if (!context.TryGetCurrentSetting("airport_ipc_compression", setting) || setting.IsNull())
+    {
+      return;
+    }
+
+    auto compression = StringUtil::Lower(setting.ToString());
+    arrow::Compression::type codec_type;
+    if (compression == "none" || compression.empty())
+    {
+      return;
+    }
+    else if (compression == "lz4_frame" || compression == "adaptive")
+    {
+      codec_type = arrow::Compression::LZ4_FRAME;
+    }
+    else if (compression == "zstd")
+    {
+      codec_type = arrow::Compression::ZSTD;
+    }
+    else
+    {
+      throw InvalidInputException("Unknown value for airport_ipc_compression: \"%s\", expected none, lz4_frame, zstd or adaptive", compression);
+    }
+
+    auto codec_result = arrow::util::Codec::Create(codec_type);
+    if (!codec_result.ok())
+    {
+      throw InvalidInputException("airport_ipc_compression: %s", codec_result.status().ToString());
+    }
+
+    call_options.write_options.codec = std::move(codec_result).ValueUnsafe();
+
+    // Only compressed batches have work to spread over threads, reading
+    // uncompressed ones on the pool would just add hand offs.
+    AirportLimitArrowCpuThreads(context);
+    call_options.read_options.use_threads = true;
+    if (compression == "adaptive")
+    {
+      // Compressing data that doesn't shrink only costs time on both sides.
+      call_options.write_options.min_space_savings = 0.25;
+    }
+
+    call_options.headers.emplace_back("airport-ipc-compression", compression == "zstd" ? "zstd" : "lz4_frame");
+  }
+}
@@ -14,6 +14,7 @@
 #include "duckdb/main/secret/secret_manager.hpp"
 #include "duckdb/planner/operator/logical_get.hpp"
 #include "duckdb/common/types/uuid.hpp"
+#include "airport_endpoint_pruning.hpp"
 #include "airport_flight_exception.hpp"
 #include "airport_flight_statistics.hpp"
 #include "airport_flight_stream.hpp"
@@ -22,15 +23,18 @@
 #include "airport_macros.hpp"
 #include "airport_request_headers.hpp"
 #include "airport_schema_utils.hpp"
+#include "airport_settings.hpp"
 #include "airport_take_flight.hpp"
 #include "duckdb/catalog/catalog_entry/table_function_catalog_entry.hpp"
 #include "duckdb/common/arrow/schema_metadata.hpp"
 #include "duckdb/function/table/arrow/arrow_duck_schema.hpp"
+#include "duckdb/parallel/task_scheduler.hpp"
 #include "duckdb/parser/tableref/table_function_ref.hpp"
 #include "duckdb/storage/statistics/numeric_stats.hpp"
 #include "msgpack.hpp"
 #include "storage/airport_catalog.hpp"
 #include "storage/airport_table_entry.hpp"
+#include "storage/airport_transaction.hpp"
 #include <openssl/bio.h>
 #include <openssl/evp.h>
 
@@ -81,6 +85,17 @@ namespace duckdb
     }
   }
 
+  std::shared_ptr<flight::FlightClient> AirportTakeFlightClient(ClientContext &context,
+                                                                const AirportTakeFlightParameters &take_flight_params,
+                                                                const AirportTableEntry *table_entry)
+  {
+    if (table_entry)
+    {
+      return AirportAPI::FlightClientForLocation(*table_entry->GetCatalog().Cast<AirportCatalog>().attach_parameters());
+    }
+    return AirportAPI::FlightClientForLocation(context, take_flight_params.server_location(), take_flight_params.secret_name());
+  }
+
   unique_ptr<FunctionData>
   AirportTakeFlightBindWithFlightDescriptor(
       const AirportTakeFlightParameters &take_flight_params,
@@ -110,6 +125,8 @@ namespace duckdb
                                descriptor);
 
     int64_t estimated_records = -1;
+    int64_t total_bytes = -1;
+    bool ordered = false;
 
     // If we are applying time travel, the schema that we have is the latest schema
     // but back in time the schema may have been different.
@@ -128,7 +145,7 @@ namespace duckdb
     if (schema == nullptr)
     {
       std::unique_ptr<arrow::flight::FlightInfo> retrieved_flight_info;
-      auto flight_client = AirportAPI::FlightClientForLocation(server_location);
+      auto flight_client = AirportTakeFlightClient(context, take_flight_params, table_entry);
 
       if (table_function_parameters != std::nullopt)
       {
@@ -199,6 +216,8 @@ namespace duckdb
       }
 
       estimated_records = retrieved_flight_info->total_records();
+      total_bytes = retrieved_flight_info->total_bytes();
+      ordered = retrieved_flight_info->ordered();
 
       arrow::ipc::DictionaryMemo dictionary_memo;
       AIRPORT_ASSIGN_OR_RAISE_LOCATION_DESCRIPTOR(schema,
@@ -232,6 +251,35 @@ namespace duckdb
     // validated by parquet_scans or other scans used in endpoints.
     ret->set_types_and_names(return_types, names);
 
+    ret->set_ordered(ordered);
+    ret->set_total_bytes(total_bytes);
+
+    // The server can declare columns that only have a single value in
+    // each endpoint, which allows DuckDB to aggregate by those columns
+    // one endpoint at a time.
+    if (ret->schema_root.arrow_schema.metadata != nullptr)
+    {
+      auto schema_metadata = ArrowSchemaMetadata(ret->schema_root.arrow_schema.metadata);
+      auto partition_keys = schema_metadata.GetOption("partition_keys");
+      if (!partition_keys.empty())
+      {
+        AIRPORT_MSGPACK_UNPACK(std::vector<std::string>, partition_key_names,
+                               partition_keys,
+                               server_location,
+                               "Failed to parse msgpack encoded partition keys.");
+
+        for (auto &partition_key_name : partition_key_names)
+        {
+          auto it = std::find(names.begin(), names.end(), partition_key_name);
+          if (it == names.end())
+          {
+            throw AirportFlightException(server_location, "Partition key column not found in flight schema: " + partition_key_name);
+          }
+          ret->add_partition_column_index(std::distance(names.begin(), it));
+        }
+      }
+    }
+
     return ret;
   }
 
@@ -301,7 +349,8 @@ namespace duckdb
                                    const AirportTakeFlightBindData &bind_data,
                                    AirportArrowScanGlobalState &global_state,
                                    AirportArrowScanLocalState &local_state,
-                                   const flight::FlightEndpoint endpoint);
+                                   const flight::FlightEndpoint endpoint,
+                                   const idx_t endpoint_index);
 
   static bool AirportArrowScanParallelStateNext(AirportArrowScanLocalState &state,
                                                 AirportArrowScanGlobalState &global_state,
@@ -313,9 +362,9 @@ namespace duckdb
       return false;
     }
     state.Reset();
-    state.batch_index++; //= ++parallel_state.batch_index;
 
     bool finished_chunk = false;
+    idx_t sequence = state.endpoint_batch_count;
     auto &reader = state.reader();
     if (std::holds_alternative<std::shared_ptr<AirportLocalScanData>>(reader))
     {
@@ -325,7 +374,12 @@ namespace duckdb
         finished_chunk = true;
       }
     }
-    else
+    else if (state.shared_stream)
+    {
+      state.endpoint_index = state.shared_stream->endpoint_index();
+      finished_chunk = !state.shared_stream->NextChunk(state, sequence);
+    }
+    else if (state.stream())
     {
       auto current_chunk = state.stream()->GetNextChunk();
       while (current_chunk->arrow_array.length == 0 && current_chunk->arrow_array.release)
@@ -336,11 +390,18 @@ namespace duckdb
 
       finished_chunk = !state.chunk->arrow_array.release;
     }
+    else
+    {
+      finished_chunk = true;
+    }
 
     //! have we run out of chunks? we are done
     if (finished_chunk)
     {
-      auto &endpoint_opt = global_state.GetNextEndpoint();
+      state.shared_stream = nullptr;
+
+      idx_t endpoint_index;
+      auto &endpoint_opt = global_state.GetNextEndpoint(endpoint_index);
       if (endpoint_opt)
       {
         if (AirportLocalStateProcessEndpoint(context,
@@ -348,17 +409,167 @@ namespace duckdb
                                              bind_data,
                                              global_state,
                                              state,
-                                             *endpoint_opt))
+                                             *endpoint_opt,
+                                             endpoint_index))
         {
           return true;
         }
       }
+      else if (global_state.share_endpoint_streams())
+      {
+        // No endpoints are left, so help convert the batches of an
+        // endpoint that another thread opened.
+        auto shared_stream = global_state.AttachSharedStream(state.endpoint_index);
+        if (shared_stream)
+        {
+          state.set_stream(nullptr);
+          state.shared_stream = std::move(shared_stream);
+          return AirportArrowScanParallelStateNext(state, global_state, bind_data, context);
+        }
+      }
       state.done = true;
       return false;
     }
+
+    // Batches are numbered by their endpoint first, so the order of the
+    // endpoints is kept when DuckDB needs to preserve insertion order.
+    // Every record batch (or chunk of a local scan function) gets the next
+    // index of its endpoint. Batch indexes have to be unique, so an endpoint
+    // with more batches than fit can't be scanned.
+    if (sequence >= AIRPORT_MAX_BATCHES_PER_ENDPOINT)
+    {
+      throw IOException("Airport: endpoint %llu of the flight sent more than %llu record batches, send fewer, larger batches",
+                        state.endpoint_index, AIRPORT_MAX_BATCHES_PER_ENDPOINT);
+    }
+    state.endpoint_batch_count = sequence + 1;
+    state.batch_index = state.endpoint_index * AIRPORT_MAX_BATCHES_PER_ENDPOINT + sequence;
     return true;
   }
 
+  bool AirportSharedScanStream::NextChunk(ArrowScanLocalState &state, idx_t &sequence)
+  {
+    std::lock_guard<std::mutex> l(lock_);
+    if (finished_)
+    {
+      state.chunk = make_uniq<ArrowArrayWrapper>();
+      return false;
+    }
+    sequence = next_sequence_++;
+
+    auto current_chunk = stream_->GetNextChunk();
+    while (current_chunk->arrow_array.length == 0 && current_chunk->arrow_array.release)
+    {
+      current_chunk = stream_->GetNextChunk();
+    }
+    state.chunk = std::move(current_chunk);
+
+    if (!state.chunk->arrow_array.release)
+    {
+      finished_ = true;
+      return false;
+    }
+    return true;
+  }
+
+  void AirportArrowScanGlobalState::EndpointOpened(shared_ptr<AirportSharedScanStream> stream)
+  {
+    if (!share_endpoint_streams_)
+    {
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> l(shared_streams_lock_);
+      D_ASSERT(opening_endpoints_ > 0);
+      opening_endpoints_--;
+      if (stream)
+      {
+        shared_streams_.push_back(std::move(stream));
+      }
+    }
+    shared_streams_cv_.notify_all();
+  }
+
+  shared_ptr<AirportSharedScanStream> AirportArrowScanGlobalState::AttachSharedStream(const idx_t minimum_endpoint_index)
+  {
+    std::unique_lock<std::mutex> l(shared_streams_lock_);
+    while (true)
+    {
+      shared_streams_.erase(std::remove_if(shared_streams_.begin(), shared_streams_.end(),
+                                           [](const shared_ptr<AirportSharedScanStream> &stream)
+                                           { return stream->finished(); }),
+                            shared_streams_.end());
+
+      vector<shared_ptr<AirportSharedScanStream>> candidates;
+      for (auto &stream : shared_streams_)
+      {
+        if (stream->endpoint_index() >= minimum_endpoint_index)
+        {
+          candidates.push_back(stream);
+        }
+      }
+
+      if (!candidates.empty())
+      {
+        return candidates[next_shared_stream_++ % candidates.size()];
+      }
+
+      if (opening_endpoints_ == 0)
+      {
+        return nullptr;
+      }
+
+      shared_streams_cv_.wait(l);
+    }
+  }
+
+  // Make sure that every endpoint handed out by GetNextEndpoint is reported
+  // as opened, even when opening it throws, otherwise threads waiting for
+  // a stream to share would wait forever.
+  struct AirportEndpointOpenGuard
+  {
+    explicit AirportEndpointOpenGuard(AirportArrowScanGlobalState &global_state) : global_state(global_state)
+    {
+    }
+
+    ~AirportEndpointOpenGuard()
+    {
+      if (!reported)
+      {
+        global_state.EndpointOpened(nullptr);
+      }
+    }
+
+    void Opened(shared_ptr<AirportSharedScanStream> stream)
+    {
+      if (reported)
+      {
+        return;
+      }
+      reported = true;
+      global_state.EndpointOpened(std::move(stream));
+    }
+
+    AirportArrowScanGlobalState &global_state;
+    bool reported = false;
+  };
+
+  static void AirportLocalStateInitializeColumns(ClientContext &context,
+                                                 const TableFunctionInitInput &input,
+                                                 const AirportTakeFlightBindData &bind_data,
+                                                 AirportArrowScanGlobalState &global_state,
+                                                 AirportArrowScanLocalState &local_state)
+  {
+    local_state.column_ids = input.column_ids;
+    local_state.filters = (TableFilterSet *)input.filters.get();
+
+    // Projection pushdown is always enabled.
+    D_ASSERT(bind_data.projection_pushdown_enabled);
+    if (!input.projection_ids.empty())
+    {
+      local_state.all_columns.Initialize(context, global_state.scanned_types());
+    }
+  }
+
   static void AirportDataFromLocalScanFunction(ClientContext &context, TableFunctionInput &data_p, DataChunk &output)
   {
     auto &state = data_p.local_state->Cast<AirportArrowScanLocalState>();
@@ -441,6 +652,48 @@ namespace duckdb
     output.Verify();
   }
 
+  // Remember the values of the partition columns of the chunk, since every
+  // row of an endpoint has the same values only the first row is looked at.
+  //
+  // The values are keyed by the table's column index, which is what
+  // get_partition_info is given and what the partition columns refer to.
+  static void AirportRecordPartitionValues(const AirportTakeFlightBindData &bind_data,
+                                           AirportArrowScanGlobalState &global_state,
+                                           AirportArrowScanLocalState &state,
+                                           const bool has_local_scan,
+                                           DataChunk &output)
+  {
+    state.partition_values.clear();
+    for (idx_t position = 0; position < state.column_ids.size(); position++)
+    {
+      const auto column_id = state.column_ids[position];
+      if (bind_data.partition_column_indexes().find(column_id) ==
+          bind_data.partition_column_indexes().end())
+      {
+        continue;
+      }
+
+      if (!has_local_scan && global_state.CanRemoveFilterColumns())
+      {
+        state.partition_values[column_id] = state.all_columns.GetValue(position, 0);
+        continue;
+      }
+
+      const auto &projection_ids = global_state.projection_ids();
+      if (projection_ids.empty())
+      {
+        state.partition_values[column_id] = output.GetValue(position, 0);
+        continue;
+      }
+
+      auto it = std::find(projection_ids.begin(), projection_ids.end(), position);
+      if (it != projection_ids.end())
+      {
+        state.partition_values[column_id] = output.GetValue(std::distance(projection_ids.begin(), it), 0);
+      }
+    }
+  }
+
   void AirportTakeFlight(ClientContext &context, TableFunctionInput &data_p, DataChunk &output)
   {
     // If the local state is null, it means there were no endpoints to scan,
@@ -472,6 +725,11 @@ namespace duckdb
 
       if (output.size() != 0)
       {
+        global_state.rows_read.fetch_add(output.size(), std::memory_order_relaxed);
+        if (!airport_bind_data.partition_column_indexes().empty())
+        {
+          AirportRecordPartitionValues(airport_bind_data, global_state, state, has_local_scan, output);
+        }
         break;
       }
 
@@ -551,6 +809,7 @@ namespace duckdb
     auto &bind_data = bind_data_p->Cast<AirportTakeFlightBindData>();
 
     bind_data.json_filters = json_result;
+    bind_data.endpoint_pruning_filters = AirportEndpointPruningFilters(get, filters);
   }
 
   shared_ptr<ArrowArrayStreamWrapper> AirportProduceArrowScan(
@@ -729,6 +988,15 @@ namespace duckdb
   {
     auto &bind_data = input.bind_data->CastNoConst<AirportTakeFlightBindData>();
 
+    // Inserts held back by the transaction have to be visible to the scan,
+    // they are sent here rather than at bind so that a statement that
+    // is only bound (PREPARE, EXPLAIN) doesn't send them.
+    if (bind_data.table_entry())
+    {
+      auto &transaction = AirportTransaction::Get(context, bind_data.table_entry()->GetCatalog());
+      transaction.FlushBufferedInserts(context, bind_data.table_entry());
+    }
+
     // Ideally this is where we call GetFlightInfo to obtain the endpoints, but
     // GetFlightInfo can't take the predicate information, so we'll need to call an
     // action called endpoints.
@@ -736,7 +1004,7 @@ namespace duckdb
     // FIXME: somehow the flight should be marked if it supports predicate pushdown.
     // right now I'm not sure what this is.
     //
-    auto flight_client = AirportAPI::FlightClientForLocation(bind_data.server_location());
+    auto flight_client = AirportTakeFlightClient(context, bind_data.take_flight_params(), bind_data.table_entry());
 
     vector<idx_t> projection_ids;
     vector<LogicalType> scanned_types;
@@ -761,29 +1029,84 @@ namespace duckdb
       }
     }
 
+    // The scan below a DELETE or UPDATE of a table without row ids would
+    // produce nothing, the statement is sent to the server as a single
+    // parameterized action, so don't ask for endpoints or open a DoGet.
+    vector<flight::FlightEndpoint> endpoints;
+    if (!bind_data.skip_producing_result_for_update_or_delete)
+    {
+      endpoints = AirportGetFlightEndpoints(bind_data.take_flight_params(),
+                                            bind_data.trace_id(),
+                                            bind_data.descriptor(),
+                                            flight_client,
+                                            bind_data.json_filters,
+                                            input.column_ids,
+                                            bind_data.table_function_parameters().has_value() ? bind_data.table_function_parameters()->parameters : "",
+                                            bind_data.table_function_parameters().has_value() ? bind_data.table_function_parameters()->table_input_schema : "");
+    }
+
+    // Skip the endpoints that the server says can't match the filters,
+    // before any thread opens them.
+    idx_t pruned_endpoints = 0;
+    if (AirportGetBooleanSetting(context, "airport_scan_prune_endpoints", true))
+    {
+      pruned_endpoints = AirportPruneEndpoints(context, bind_data, endpoints);
+    }
+
     auto result = make_uniq<AirportArrowScanGlobalState>(
-        AirportGetFlightEndpoints(bind_data.take_flight_params(),
-                                  bind_data.trace_id(),
-                                  bind_data.descriptor(),
-                                  flight_client,
-                                  bind_data.json_filters,
-                                  input.column_ids,
-                                  bind_data.table_function_parameters().has_value() ? bind_data.table_function_parameters()->parameters : "",
-                                  bind_data.table_function_parameters().has_value() ? bind_data.table_function_parameters()->table_input_schema : ""),
+        std::move(endpoints),
         projection_ids,
         scanned_types,
         input);
+    result->pruned_endpoints = pruned_endpoints;
 
     // Store the total number of endpoints in the bind data so progress
     // can be reported across all endpoints.
     bind_data.set_endpoint_count(result->total_endpoints());
 
+    // With fewer endpoints than threads the endpoint streams are shared, so
+    // the conversion of a single large endpoint can use every thread.
+    const idx_t thread_count = (idx_t)TaskScheduler::GetScheduler(context).NumberOfThreads();
+    if (result->total_endpoints() > 0 &&
+        result->total_endpoints() < thread_count &&
+        AirportGetBooleanSetting(context, "airport_scan_share_endpoint_streams", true))
+    {
+      result->enable_shared_endpoint_streams(thread_count);
+    }
+
     return result;
   }
 
   double AirportTakeFlightScanProgress(ClientContext &, const FunctionData *data, const GlobalTableFunctionState *global_state)
   {
-    return data->Cast<AirportTakeFlightBindData>().total_progress();
+    auto &bind_data = data->Cast<AirportTakeFlightBindData>();
+
+    // DuckDB expects progress as a percentage, servers report the fraction
+    // of each endpoint that has been sent (0.0 to 1.0).
+    double_t reported;
+    if (bind_data.reported_progress(reported))
+    {
+      return MinValue<double>(100.0, 100.0 * reported);
+    }
+
+    // The server doesn't report progress, so estimate it from the rows or
+    // bytes that have been read against the totals from the flight info.
+    if (!global_state)
+    {
+      return 0.0;
+    }
+    auto &scan_global_state = global_state->Cast<AirportArrowScanGlobalState>();
+    if (bind_data.estimated_records() > 0)
+    {
+      return MinValue<double>(100.0, 100.0 * (double)scan_global_state.rows_read.load(std::memory_order_relaxed) /
+                                         (double)bind_data.estimated_records());
+    }
+    if (bind_data.total_bytes() > 0)
+    {
+      return MinValue<double>(100.0, 100.0 * (double)scan_global_state.bytes_read.load(std::memory_order_relaxed) /
+                                         (double)bind_data.total_bytes());
+    }
+    return 0.0;
   }
 
   static std::vector<uint8_t> base64_decode(const std::string &base64_input)
@@ -817,9 +1140,12 @@ namespace duckdb
                                    const AirportTakeFlightBindData &bind_data,
                                    AirportArrowScanGlobalState &global_state,
                                    AirportArrowScanLocalState &local_state,
-                                   const flight::FlightEndpoint endpoint)
+                                   const flight::FlightEndpoint endpoint,
+                                   const idx_t endpoint_index)
   {
-    auto flight_client = AirportAPI::FlightClientForLocation(bind_data.server_location());
+    AirportEndpointOpenGuard open_guard(global_state);
+
+    auto flight_client = AirportTakeFlightClient(context, bind_data.take_flight_params(), bind_data.table_entry());
 
     if (endpoint.locations.empty())
     {
@@ -831,6 +1157,13 @@ namespace duckdb
     auto server_location = location.ToString();
 
     local_state.lines_read = 0;
+    local_state.prefetch_max_bytes = 0;
+    local_state.shared_stream = nullptr;
+    local_state.endpoint_index = endpoint_index;
+    local_state.endpoint_batch_count = 0;
+    local_state.realigned_bytes = &global_state.realigned_bytes;
+    local_state.bytes_read = &global_state.bytes_read;
+    local_state.flight_client = flight_client;
     local_state.chunk_offset = 0;
     local_state.chunk = make_uniq<ArrowArrayWrapper>();
     local_state.Reset();
@@ -947,11 +1280,14 @@ namespace duckdb
                                            server_location,
                                            "airport_take_flight: opening data URI");
 
+          auto read_options = arrow::ipc::IpcReadOptions::Defaults();
+          read_options.memory_pool = local_state.memory_pool;
+
           if (location_data.format == "ipc-stream")
           {
             AIRPORT_ASSIGN_OR_RAISE_LOCATION(
                 auto reader,
-                arrow::ipc::RecordBatchStreamReader::Open(input_file),
+                arrow::ipc::RecordBatchStreamReader::Open(input_file, read_options),
                 server_location,
                 "airport_take_flight: opening data URI")
 
@@ -966,7 +1302,7 @@ namespace duckdb
           {
             AIRPORT_ASSIGN_OR_RAISE_LOCATION(
                 auto reader,
-                arrow::ipc::RecordBatchFileReader::Open(input_file),
+                arrow::ipc::RecordBatchFileReader::Open(input_file, read_options),
                 server_location,
                 "airport_take_flight: opening data URI")
 
@@ -1000,6 +1336,10 @@ namespace duckdb
                                  bind_data.trace_id(),
                                  descriptor);
 
+      AirportUseMemoryPool(context, call_options);
+
+      AirportUseIpcCompression(context, call_options);
+
       if (bind_data.skip_producing_result_for_update_or_delete)
       {
         // This is a special case where the result of the scan should be skipped.
@@ -1026,6 +1366,9 @@ namespace duckdb
 
       // Can we reuse the chunk?
       local_state.set_reader(std::move(stream));
+
+      // Read ahead on the DoGet stream while this thread converts batches.
+      local_state.prefetch_max_bytes = AirportScanPrefetchBytes(context);
     }
 
     if (!std::holds_alternative<std::shared_ptr<AirportLocalScanData>>(local_state.reader()))
@@ -1034,12 +1377,21 @@ namespace duckdb
           AirportProduceArrowScan(bind_data,
                                   input.column_ids,
                                   input.filters.get(),
-                                  bind_data.get_progress_counter(0),
+                                  bind_data.get_progress_counter(endpoint_index),
                                   // No need for the last metadata message.
                                   nullptr,
                                   bind_data.schema(),
                                   bind_data,
                                   local_state));
+
+      if (global_state.share_endpoint_streams())
+      {
+        // Hand the stream to the other scan threads as well, this thread
+        // reads from it through the shared stream like everyone else.
+        local_state.shared_stream = make_shared_ptr<AirportSharedScanStream>(local_state.stream(), endpoint_index);
+        local_state.set_stream(nullptr);
+        open_guard.Opened(local_state.shared_stream);
+      }
     }
     else
     {
@@ -1047,15 +1399,10 @@ namespace duckdb
       local_state.set_stream(nullptr);
     }
 
-    local_state.column_ids = input.column_ids;
-    local_state.filters = (TableFilterSet *)input.filters.get();
+    open_guard.Opened(nullptr);
+
+    AirportLocalStateInitializeColumns(context, input, bind_data, global_state, local_state);
 
-    // Projection pushdown is always enabled.
-    D_ASSERT(bind_data.projection_pushdown_enabled);
-    if (!input.projection_ids.empty())
-    {
-      local_state.all_columns.Initialize(context, global_state.scanned_types());
-    }
     if (!AirportArrowScanParallelStateNext(local_state,
                                            global_state,
                                            bind_data,
@@ -1073,11 +1420,29 @@ namespace duckdb
     auto &bind_data = input.bind_data->Cast<AirportTakeFlightBindData>();
     auto &global_state = global_state_p->Cast<AirportArrowScanGlobalState>();
 
-    auto &endpoint_opt = global_state.GetNextEndpoint();
+    idx_t endpoint_index;
+    auto &endpoint_opt = global_state.GetNextEndpoint(endpoint_index);
 
-    // If there are no endpoints, don't create a local state.
     if (!endpoint_opt)
     {
+      // There are more threads than endpoints, so this thread can only
+      // help to convert the batches of an endpoint opened by another thread.
+      if (global_state.share_endpoint_streams())
+      {
+        auto shared_stream = global_state.AttachSharedStream(0);
+        if (shared_stream)
+        {
+          auto result = make_uniq<AirportArrowScanLocalState>(
+              make_uniq<ArrowArrayWrapper>(),
+              context,
+              input);
+          AirportLocalStateInitializeColumns(context, input, bind_data, global_state, *result);
+          result->shared_stream = std::move(shared_stream);
+          return result;
+        }
+      }
+
+      // If there are no endpoints, don't create a local state.
       return nullptr;
     }
 
@@ -1092,7 +1457,8 @@ namespace duckdb
                                      bind_data,
                                      global_state,
                                      *result,
-                                     *endpoint_opt);
+                                     *endpoint_opt,
+                                     endpoint_index);
     return result;
   }
 
@@ -1114,6 +1480,64 @@ namespace duckdb
     return bind_info;
   }
 
+  static TablePartitionInfo AirportTakeFlightGetPartitionInfo(ClientContext &context, TableFunctionPartitionInput &input)
+  {
+    if (input.partition_ids.empty())
+    {
+      return TablePartitionInfo::NOT_PARTITIONED;
+    }
+    auto &bind_data = input.bind_data->Cast<AirportTakeFlightBindData>();
+    for (auto &partition_id : input.partition_ids)
+    {
+      if (bind_data.partition_column_indexes().find(partition_id) == bind_data.partition_column_indexes().end())
+      {
+        return TablePartitionInfo::NOT_PARTITIONED;
+      }
+    }
+    return TablePartitionInfo::SINGLE_VALUE_PARTITIONS;
+  }
+
+  static OperatorPartitionData AirportTakeFlightGetPartitionData(ClientContext &context, TableFunctionGetPartitionInput &input)
+  {
+    if (!input.local_state)
+    {
+      // No endpoints were scanned by this thread.
+      return OperatorPartitionData(0);
+    }
+    auto &state = input.local_state->Cast<AirportArrowScanLocalState>();
+    OperatorPartitionData result(state.batch_index);
+    if (input.partition_info.RequiresPartitionColumns())
+    {
+      for (auto &partition_column : input.partition_info.partition_columns)
+      {
+        auto it = state.partition_values.find(partition_column);
+        if (it == state.partition_values.end())
+        {
+          throw InternalException("airport_take_flight: no value recorded for partition column");
+        }
+        result.partition_data.emplace_back(it->second);
+      }
+    }
+    return result;
+  }
+
+  static InsertionOrderPreservingMap<string> AirportTakeFlightDynamicToString(TableFunctionDynamicToStringInput &input)
+  {
+    InsertionOrderPreservingMap<string> result;
+    if (input.bind_data)
+    {
+      result["Ordered"] = input.bind_data->Cast<AirportTakeFlightBindData>().ordered() ? "true" : "false";
+    }
+    if (!input.global_state)
+    {
+      return result;
+    }
+    auto &global_state = input.global_state->Cast<AirportArrowScanGlobalState>();
+    result["Realigned Bytes"] = to_string(global_state.realigned_bytes.load(std::memory_order_relaxed));
+    result["Pruned Endpoints"] = to_string(global_state.pruned_endpoints);
+    return result;
+  }
+
   void AirportAddTakeFlightFunction(ExtensionLoader &loader)
   {
 
@@ -1137,10 +1561,12 @@ namespace duckdb
     take_flight_function_with_descriptor.pushdown_complex_filter = AirportTakeFlightComplexFilterPushdown;
 
     take_flight_function_with_descriptor.cardinality = AirportTakeFlightCardinality;
-    //    take_flight_function_with_descriptor.get_batch_index = nullptr;
+    take_flight_function_with_descriptor.get_partition_data = AirportTakeFlightGetPartitionData;
+    take_flight_function_with_descriptor.get_partition_info = AirportTakeFlightGetPartitionInfo;
     take_flight_function_with_descriptor.projection_pushdown = true;
     take_flight_function_with_descriptor.filter_pushdown = false;
     take_flight_function_with_descriptor.table_scan_progress = AirportTakeFlightScanProgress;
+    take_flight_function_with_descriptor.dynamic_to_string = AirportTakeFlightDynamicToString;
     take_flight_function_set.AddFunction(take_flight_function_with_descriptor);
 
     auto take_flight_function_with_pointer = TableFunction(
@@ -1161,10 +1587,12 @@ namespace duckdb
     // of the flight, ideally parameters would be JSON encoded.
 
     take_flight_function_with_pointer.cardinality = AirportTakeFlightCardinality;
-    //    take_flight_function_with_pointer.get_batch_index = nullptr;
+    take_flight_function_with_pointer.get_partition_data = AirportTakeFlightGetPartitionData;
+    take_flight_function_with_pointer.get_partition_info = AirportTakeFlightGetPartitionInfo;
     take_flight_function_with_pointer.projection_pushdown = true;
     take_flight_function_with_pointer.filter_pushdown = false;
     take_flight_function_with_pointer.table_scan_progress = AirportTakeFlightScanProgress;
+    take_flight_function_with_pointer.dynamic_to_string = AirportTakeFlightDynamicToString;
     take_flight_function_with_pointer.statistics = AirportTakeFlightStatistics;
     take_flight_function_with_pointer.get_bind_info = AirportTakeFlightGetBindInfo;
 
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/planner/table_filter.hpp"
+#include <arrow/flight/types.h>
+
+namespace duckdb
+{
+  class LogicalGet;
+  struct AirportTakeFlightBindData;
+
+  // Build the filters that can be checked against the statistics of an
+  // endpoint from the filters pushed down to a scan. Only comparisons of a
+  // column with a constant and IS [NOT] NULL (combined with AND) are used,
+  // the filters are keyed by the index of the column in the table.
+  //
+  // The filters are still applied to the rows by DuckDB, these are only
+  // used to skip endpoints.
+  unique_ptr<TableFilterSet> AirportEndpointPruningFilters(LogicalGet &get, const vector<unique_ptr<Expression>> &filters);
+
+  // Remove the endpoints whose statistics show they can't contain any rows
+  // matching the pruning filters of the bind data, returns the number of
+  // endpoints removed.
+  //
+  // Servers can describe the data of an endpoint in its app_metadata with
+  // a msgpack encoded map:
+  //
+  //   {"column_statistics": {"<column name>": {"min": ..., "max": ...,
+  //                                            "null_count": ..., "row_count": ...}}}
+  //
+  // Every field is optional, min and max can be any msgpack scalar that can
+  // be cast to the type of the column. Endpoints with app_metadata in any
+  // other format are never removed.
+  idx_t AirportPruneEndpoints(ClientContext &context,
+                              const AirportTakeFlightBindData &bind_data,
+                              vector<arrow::flight::FlightEndpoint> &endpoints);
+}
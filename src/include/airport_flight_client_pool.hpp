@@ -0,0 +1,122 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include <arrow/flight/client.h>
+
+namespace duckdb
+{
+  // Transport tuning for the gRPC channels of Flight clients, every value
+  // is -1 when it isn't set so gRPC's (or Arrow's) default is used.
+  //
+  // The same names (prefixed with airport_ for the settings) are accepted
+  // as DuckDB settings, ATTACH options and secret values.
+  struct AirportFlightClientOptions
+  {
+    // grpc.max_receive_message_length
+    int64_t grpc_max_receive_message_size = -1;
+    // grpc.max_send_message_length
+    int64_t grpc_max_send_message_size = -1;
+    // grpc.http2.lookahead_bytes, the HTTP/2 flow control window, setting
+    // it turns off gRPC's bandwidth delay product probing.
+    int64_t grpc_initial_window_size = -1;
+    // grpc.keepalive_time_ms
+    int64_t grpc_keepalive_time_ms = -1;
+    // grpc.keepalive_timeout_ms
+    int64_t grpc_keepalive_timeout_ms = -1;
+    // grpc.enable_http_proxy, 0 stops gRPC from using http_proxy from the environment.
+    int64_t grpc_enable_http_proxy = -1;
+    // FlightClientOptions::write_size_limit_bytes
+    int64_t grpc_write_size_limit_bytes = -1;
+
+    // Set an option by name, returns false if the name isn't an option.
+    bool Set(const string &name, const Value &value);
+
+    // Use the values of other that are set in place of these.
+    void Merge(const AirportFlightClientOptions &other);
+
+    void Apply(arrow::flight::FlightClientOptions &options) const;
+
+    bool operator==(const AirportFlightClientOptions &other) const;
+
+    static const vector<string> &Names();
+  };
+
+  // The options of the airport_grpc_* settings, they apply to every location.
+  void AirportAddFlightClientSettings(DBConfig &config);
+
+  // The options of the airport_grpc_* settings of the context.
+  AirportFlightClientOptions AirportFlightClientOptionsFromSettings(ClientContext &context);
+
+  // A set of Flight clients that all connect to the same location, each
+  // client has its own gRPC channel and so its own HTTP/2 connection.
+  //
+  // Calls are spread over the clients so that concurrent scans and DML
+  // statements aren't limited to the flow control window of a single
+  // connection.
+  class AirportFlightClientPool
+  {
+  public:
+    AirportFlightClientPool(const string &location, const idx_t channel_count, const AirportFlightClientOptions &options);
+
+    // Get the client that should be used for the next call, the client
+    // counts as in use until the returned pointer is released.
+    std::shared_ptr<arrow::flight::FlightClient> Acquire();
+
+    const string &location() const
+    {
+      return location_;
+    }
+
+    const AirportFlightClientOptions &options() const
+    {
+      return options_;
+    }
+
+    idx_t channel_count() const
+    {
+      return clients_.size();
+    }
+
+    // The number of clients that have been acquired and not released,
+    // a client is usually held for the duration of a scan or a statement
+    // rather than a single call.
+    idx_t clients_in_use() const;
+
+    idx_t total_requests() const
+    {
+      return total_requests_.load(std::memory_order_relaxed);
+    }
+
+  private:
+    const string location_;
+    const AirportFlightClientOptions options_;
+
+    struct PooledClient
+    {
+      std::shared_ptr<arrow::flight::FlightClient> client;
+      std::atomic<idx_t> in_use = 0;
+    };
+
+    vector<std::shared_ptr<PooledClient>> clients_;
+    std::atomic<idx_t> next_client_ = 0;
+    std::atomic<idx_t> total_requests_ = 0;
+  };
+
+  static constexpr idx_t AIRPORT_DEFAULT_FLIGHT_CHANNELS_PER_LOCATION = 4;
+
+  // The number of channels that are opened to each location, from the
+  // airport_flight_channels_per_location setting of the context.
+  idx_t AirportFlightChannelsPerLocation(ClientContext &context);
+  void AirportCheckFlightChannelsPerLocation(ClientContext &context, SetScope scope, Value &parameter);
+
+  // Get the pool of clients for a location with the channel count and
+  // options, creating it if needed.
+  //
+  // The lookup doesn't take a lock, the pools are kept in an immutable map
+  // that is replaced when a pool is added.
+  shared_ptr<AirportFlightClientPool> AirportFlightClientPoolForLocation(const string &location,
+                                                                        const idx_t channel_count,
+                                                                        const AirportFlightClientOptions &options);
+
+  void AirportAddFlightClientPoolsFunction(ExtensionLoader &loader);
+}
@@ -18,7 +18,10 @@
 #include "msgpack.hpp"
 #include "airport_location_descriptor.hpp"
 #include "airport_macros.hpp"
+#include "airport_memory_pool.hpp"
 
+#include "duckdb/common/unordered_set.hpp"
+#include "duckdb/planner/table_filter.hpp"
 #include "duckdb/parallel/thread_context.hpp"
 #include "duckdb/parser/tableref/table_function_ref.hpp"
 #include "duckdb/catalog/catalog_entry/table_function_catalog_entry.hpp"
@@ -158,6 +161,7 @@ namespace duckdb
   };
 
   struct AirportArrowScanGlobalState;
+  class AirportSharedScanStream;
 
   struct AirportDuckDBFunctionCallParsed
   {
@@ -232,6 +236,7 @@ namespace duckdb
                                         std::shared_ptr<arrow::flight::FlightStreamReader> reader,
                                         TableFunctionInitInput &input)
         : ArrowScanLocalState(std::move(current_chunk), context),
+          memory_pool(&AirportMemoryPool::Get(context)),
           reader_(std::move(reader)),
           input_(input)
     {
@@ -243,6 +248,7 @@ namespace duckdb
                                         ClientContext &context,
                                         TableFunctionInitInput &input)
         : ArrowScanLocalState(std::move(current_chunk), context),
+          memory_pool(&AirportMemoryPool::Get(context)),
           reader_(std::shared_ptr<arrow::flight::FlightStreamReader>(nullptr)), input_(input)
     {
     }
@@ -299,6 +305,41 @@ namespace duckdb
   public:
     idx_t lines_read = 0;
 
+    // When non-zero the record batches of a Flight stream are read on a
+    // background thread, holding at most this many bytes ahead of the
+    // conversion to DuckDB vectors.
+    idx_t prefetch_max_bytes = 0;
+
+    // Set when this thread is converting batches from an endpoint stream
+    // that is shared with other scan threads.
+    shared_ptr<AirportSharedScanStream> shared_stream;
+
+    // The index of the endpoint being read and the number of batches read
+    // from it, used to produce batch indexes that follow the endpoint order.
+    idx_t endpoint_index = 0;
+    idx_t endpoint_batch_count = 0;
+
+    // The values of the partition columns for the current batch, by
+    // the table's column index, only filled in if the flight declares
+    // partition keys.
+    unordered_map<idx_t, Value> partition_values;
+
+    // If set, the number of bytes copied to realign the buffers of
+    // received batches is added to this counter.
+    atomic<idx_t> *realigned_bytes = nullptr;
+
+    // If set, the size of the buffers of every received batch is added to
+    // this counter, it is used to estimate the progress of the scan.
+    atomic<idx_t> *bytes_read = nullptr;
+
+    // The client the current endpoint is read with, kept so the client
+    // pool counts the stream as active until the endpoint is done.
+    std::shared_ptr<arrow::flight::FlightClient> flight_client;
+
+    // The pool used for the memory of received batches, it belongs to the
+    // connection so it is tracked against DuckDB's memory limit.
+    arrow::MemoryPool *memory_pool;
+
   private:
     ReaderDelegate reader_;
 
@@ -337,6 +378,10 @@ namespace duckdb
 
     string json_filters;
 
+    // The pushed down filters that can be checked against the statistics
+    // servers attach to endpoints, keyed by table column index.
+    unique_ptr<TableFilterSet> endpoint_pruning_filters;
+
     idx_t rowid_column_index = COLUMN_IDENTIFIER_ROW_ID;
 
     // Force no-result
@@ -359,6 +404,18 @@ namespace duckdb
       return estimated_records_;
     }
 
+    // The total size of the flight in bytes as reported by the flight info,
+    // -1 if unknown.
+    int64_t total_bytes() const
+    {
+      return total_bytes_;
+    }
+
+    void set_total_bytes(const int64_t total_bytes)
+    {
+      total_bytes_ = total_bytes;
+    }
+
     const AirportTakeFlightParameters &take_flight_params() const
     {
       return take_flight_params_;
@@ -380,7 +437,8 @@ namespace duckdb
       progress_array = std::unique_ptr<std::atomic<double>[]>(new std::atomic<double>[endpoint_count]);
       for (size_t i = 0; i < endpoint_count; i++)
       {
-        progress_array[i].store(0.0);
+        // Negative until the server reports progress for the endpoint.
+        progress_array[i].store(-1.0);
       }
     }
 
@@ -396,18 +454,28 @@ namespace duckdb
       }
     }
 
-    double_t total_progress() const
+    // The average of the progress reported by the server for each endpoint
+    // as a fraction (0.0 to 1.0), returns false if the server hasn't
+    // reported progress for any endpoint.
+    bool reported_progress(double_t &result) const
     {
       double_t total = 0.0;
-      if (total_endpoints_ == 0)
+      bool reported = false;
+      for (size_t i = 0; i < total_endpoints_; i++)
       {
-        return 0.0;
+        auto progress = progress_array[i].load(std::memory_order_relaxed);
+        if (progress >= 0.0)
+        {
+          total += progress;
+          reported = true;
+        }
       }
-      for (size_t i = 0; i < total_endpoints_; i++)
+      if (!reported)
       {
-        total += progress_array[i].load(std::memory_order_relaxed); // or acquire
+        return false;
       }
-      return total / (double_t)total_endpoints_;
+      result = total / (double_t)total_endpoints_;
+      return true;
     }
 
     std::shared_ptr<arrow::Buffer> last_app_metadata = nullptr;
@@ -433,6 +501,31 @@ namespace duckdb
       return table_entry_;
     }
 
+    // If the flight info declared that its endpoints are ordered, meaning
+    // the rows of the flight are the rows of each endpoint in turn.
+    bool ordered() const
+    {
+      return ordered_;
+    }
+
+    void set_ordered(const bool ordered)
+    {
+      ordered_ = ordered;
+    }
+
+    // The columns that have a single value for all of the rows of an
+    // endpoint, declared by the server with the "partition_keys" schema
+    // metadata.
+    const unordered_set<idx_t> &partition_column_indexes() const
+    {
+      return partition_column_indexes_;
+    }
+
+    void add_partition_column_index(const idx_t column_index)
+    {
+      partition_column_indexes_.insert(column_index);
+    }
+
   private:
     // The total number of endpoints that will be scanned, this is used
     // in calculating the progress of the scan.
@@ -447,6 +540,8 @@ namespace duckdb
     // returned from GetFlightInfo, but that could also come from the table itself.
     int64_t estimated_records_ = -1;
 
+    int64_t total_bytes_ = -1;
+
     const AirportTakeFlightParameters take_flight_params_;
     const std::optional<AirportTableFunctionFlightInfoParameters> table_function_parameters_;
 
@@ -456,6 +551,10 @@ namespace duckdb
     vector<string> return_names_;
 
     const AirportTableEntry *table_entry_ = nullptr;
+
+    bool ordered_ = false;
+
+    unordered_set<idx_t> partition_column_indexes_;
   };
 
   duckdb::unique_ptr<duckdb::ArrowArrayStreamWrapper>
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/main/client_context_state.hpp"
+#include <arrow/memory_pool.h>
+#include <arrow/flight/client.h>
+
+namespace duckdb
+{
+  // An Arrow memory pool that allocates from DuckDB's buffer allocator,
+  // so that memory used by Arrow record batches (IPC decoding, realignment,
+  // decompression) counts against DuckDB's memory_limit rather than being
+  // invisible to it.
+  //
+  // Each connection has its own pool which tracks the peak memory used by
+  // the current query, airport_memory_usage() reports it along with the
+  // peak of the previous query.
+  //
+  // Arrow buffers only keep a raw pointer to their pool and can outlive the
+  // connection, so the pool is reference counted by its owner and by every
+  // allocation that hasn't been freed, and it keeps the database (and so
+  // its allocator) alive until the last of them is gone.
+  class AirportMemoryPool : public arrow::MemoryPool
+  {
+  public:
+    explicit AirportMemoryPool(shared_ptr<DatabaseInstance> db);
+
+    // Get the pool for the connection of the context.
+    static AirportMemoryPool &Get(ClientContext &context);
+
+    arrow::Status Allocate(int64_t size, int64_t alignment, uint8_t **out) override;
+    arrow::Status Reallocate(int64_t old_size, int64_t new_size, int64_t alignment, uint8_t **ptr) override;
+    void Free(uint8_t *buffer, int64_t size, int64_t alignment) override;
+
+    int64_t bytes_allocated() const override
+    {
+      return bytes_allocated_.load(std::memory_order_relaxed);
+    }
+
+    int64_t max_memory() const override
+    {
+      return max_memory_.load(std::memory_order_relaxed);
+    }
+
+    int64_t total_bytes_allocated() const override
+    {
+      return total_bytes_allocated_.load(std::memory_order_relaxed);
+    }
+
+    int64_t num_allocations() const override
+    {
+      return num_allocations_.load(std::memory_order_relaxed);
+    }
+
+    std::string backend_name() const override
+    {
+      return "duckdb";
+    }
+
+    // Start tracking a new peak from the memory that is currently allocated.
+    void ResetPeak()
+    {
+      max_memory_.store(bytes_allocated(), std::memory_order_relaxed);
+    }
+
+    // Remember the peak of the query that just finished.
+    void FinishQuery()
+    {
+      last_query_peak_.store(max_memory(), std::memory_order_relaxed);
+    }
+
+    int64_t last_query_peak() const
+    {
+      return last_query_peak_.load(std::memory_order_relaxed);
+    }
+
+    // Drop the owner's reference, the pool is deleted once every
+    // allocation has been freed as well.
+    void Release();
+
+  private:
+    void UpdateAllocated(int64_t diff);
+
+    shared_ptr<DatabaseInstance> db_;
+    Allocator &allocator_;
+    // The owner plus the number of allocations that haven't been freed.
+    std::atomic<idx_t> references_ = 1;
+
+    std::atomic<int64_t> bytes_allocated_ = 0;
+    std::atomic<int64_t> max_memory_ = 0;
+    std::atomic<int64_t> total_bytes_allocated_ = 0;
+    std::atomic<int64_t> num_allocations_ = 0;
+    std::atomic<int64_t> last_query_peak_ = 0;
+  };
+
+  // Keeps the memory pool of a connection and resets its peak at the start
+  // of every query.
+  class AirportMemoryPoolState : public ClientContextState
+  {
+  public:
+    explicit AirportMemoryPoolState(ClientContext &context);
+    ~AirportMemoryPoolState() override;
+
+    void QueryBegin(ClientContext &context) override
+    {
+      pool_->ResetPeak();
+    }
+
+    void QueryEnd() override
+    {
+      pool_->FinishQuery();
+    }
+
+    AirportMemoryPool &pool()
+    {
+      return *pool_;
+    }
+
+  private:
+    AirportMemoryPool *pool_;
+  };
+
+  // Make the IPC reading and writing of a Flight call allocate from the
+  // memory pool of the connection.
+  void AirportUseMemoryPool(ClientContext &context, arrow::flight::FlightCallOptions &call_options);
+
+  void AirportAddMemoryUsageFunction(ExtensionLoader &loader);
+}
@@ -2,6 +2,7 @@
 
 #include "duckdb.hpp"
 #include "duckdb/common/arrow/schema_metadata.hpp"
+#include "duckdb/common/operator/cast_operators.hpp"
 #include "duckdb/function/table/arrow.hpp"
 #include "duckdb/parser/parsed_data/create_table_info.hpp"
 #include "duckdb/parser/parser.hpp"
@@ -10,6 +11,9 @@
 #include "airport_macros.hpp"
 #include "airport_secrets.hpp"
 #include "arrow/util/key_value_metadata.h"
+#include "storage/airport_exchange.hpp"
+#include "airport_scalar_function_cache.hpp"
+#include <deque>
 
 namespace duckdb
 {
@@ -67,6 +71,100 @@ namespace duckdb
       return false;
     }
 
+    // A value of the metadata of the function's input schema, servers use
+    // it to describe how the function should be called. Returns an empty
+    // string if the key isn't present.
+    string input_schema_metadata(const string &key) const
+    {
+      auto metadata = input_schema_->metadata();
+      if (metadata == nullptr)
+      {
+        return "";
+      }
+      auto value = metadata->Get(key);
+      if (!value.ok())
+      {
+        return "";
+      }
+      return *value;
+    }
+
+    // Servers can declare the number of rows they would like to be sent
+    // in each batch with "preferred_batch_rows", chunks are then collected
+    // until there are at least that many rows. Returns 0 if nothing was
+    // declared.
+    idx_t preferred_batch_rows() const
+    {
+      idx_t result;
+      auto value = input_schema_metadata("preferred_batch_rows");
+      if (!TryCast::Operation(string_t(value), result))
+      {
+        return 0;
+      }
+      return result;
+    }
+
+    // Functions that are called on few distinct values can ask for only
+    // the distinct argument tuples of each batch to be sent with
+    // "deduplicate_arguments".
+    //
+    // A batch of a single chunk with one argument column that is a
+    // dictionary sends the dictionary as it is. Every other batch is
+    // deduplicated by hashing and comparing its rows.
+    bool deduplicate_arguments() const
+    {
+      bool result;
+      auto value = input_schema_metadata("deduplicate_arguments");
+      if (!TryCast::Operation(string_t(value), result))
+      {
+        return false;
+      }
+      return result;
+    }
+
+    // Functions that always return the same result for the same arguments
+    // are marked with "deterministic", their results are cached.
+    bool deterministic() const
+    {
+      bool result;
+      auto value = input_schema_metadata("deterministic");
+      if (!TryCast::Operation(string_t(value), result))
+      {
+        return false;
+      }
+      return result;
+    }
+
+    // The stability DuckDB's optimizer may assume for the function, given
+    // by the server with "stability" as "consistent",
+    // "consistent_within_query" or "volatile". Deterministic functions are
+    // consistent unless they say otherwise, everything else is volatile so
+    // every call goes to the server.
+    FunctionStability stability() const
+    {
+      auto value = StringUtil::Lower(input_schema_metadata("stability"));
+      if (value == "consistent")
+      {
+        return FunctionStability::CONSISTENT;
+      }
+      else if (value == "consistent_within_query")
+      {
+        return FunctionStability::CONSISTENT_WITHIN_QUERY;
+      }
+      else if (value.empty() && deterministic())
+      {
+        return FunctionStability::CONSISTENT;
+      }
+      return FunctionStability::VOLATILE;
+    }
+
+    // The version of the function given by the server with
+    // "function_version", cached results of other versions aren't used.
+    string function_version() const
+    {
+      return input_schema_metadata("function_version");
+    }
+
     const std::shared_ptr<arrow::Schema> &output_schema() const
     {
       return output_schema_;
@@ -78,6 +176,97 @@ namespace duckdb
     }
   };
 
+  // So the local state of an airport provided scalar function is going to setup a
+  // lot of the functionality necessary.
+  //
+  // Its going to create the flight client, call the DoExchange endpoint,
+  //
+  // Its going to send the schema of the stream that we're going to write to the server
+  // and its going to read the schema of the strema that is returned.
+  struct AirportScalarFunctionLocalState : public FunctionLocalState, public AirportLocationDescriptor
+  {
+    AirportScalarFunctionLocalState(ClientContext &context,
+                                    std::shared_ptr<arrow::flight::FlightClient> flight_client,
+                                    const AirportLocationDescriptor &location_descriptor,
+                                    const std::shared_ptr<arrow::Schema> &function_output_schema,
+                                    const std::shared_ptr<arrow::Schema> &function_input_schema,
+                                    const std::optional<std::string> &transaction_id,
+                                    bool read_ahead,
+                                    bool deduplicate_arguments = false,
+                                    shared_ptr<AirportScalarFunctionCache::Function> cache_function = nullptr);
+
+  public:
+    const std::shared_ptr<arrow::Schema> &function_input_schema() const
+    {
+      return function_input_schema_;
+    }
+
+    const std::shared_ptr<arrow::Schema> &function_output_schema() const
+    {
+      return function_output_schema_;
+    }
+
+    void process_chunk(DataChunk &args, ExpressionState &state, Vector &result);
+
+    // Write the arguments of a chunk to the stream.
+    void send_chunk(ClientContext &context, DataChunk &args);
+
+    // Write the arguments of several chunks to the stream as one batch.
+    void send_chunks(ClientContext &context, const vector<reference<DataChunk>> &chunks);
+
+    // Read the results of the next count rows that were sent.
+    void receive_result(ClientContext &context, idx_t count, Vector &result);
+
+  private:
+    void send_cached_chunks(ClientContext &context, const vector<reference<DataChunk>> &chunks);
+    void write_batch(ClientContext &context, const vector<reference<DataChunk>> &chunks);
+    void receive_rows(ClientContext &context, idx_t count, Vector &result);
+
+    struct DeduplicatedChunk
+    {
+      idx_t count;
+      // The distinct row of each row of the chunk.
+      SelectionVector rows;
+      // The results of the rows that were found in the cache.
+      idx_t cached_rows = 0;
+      unique_ptr<Vector> cached;
+      vector<bool> is_cached;
+    };
+
+    // A batch that was sent with only its distinct argument tuples.
+    struct DeduplicatedBatch
+    {
+      idx_t distinct_rows = 0;
+      std::deque<DeduplicatedChunk> chunks;
+      // The cache keys of the arguments of the distinct rows.
+      vector<string> keys;
+      // The results of the distinct rows, read with the first chunk.
+      unique_ptr<Vector> results;
+    };
+    std::deque<DeduplicatedBatch> deduplicated_;
+    const bool deduplicate_arguments_;
+    const shared_ptr<AirportScalarFunctionCache::Function> cache_function_;
+    // The lease on the pooled client, held as long as the exchange is open
+    // so the client counts as in use. Declared before the streams so it is
+    // released after them.
+    const std::shared_ptr<arrow::flight::FlightClient> flight_client_;
+
+    std::unique_ptr<AirportExchangeTakeFlightBindData> scan_bind_data_;
+    std::unique_ptr<AirportArrowScanGlobalState> scan_global_state_;
+    std::unique_ptr<AirportArrowScanLocalState> scan_local_state_;
+    std::unique_ptr<arrow::flight::FlightStreamWriter> writer_;
+
+    const std::shared_ptr<arrow::Schema> function_output_schema_;
+    const std::shared_ptr<arrow::Schema> function_input_schema_;
+    const std::optional<std::string> transaction_id_;
+  };
+
+  // Open the stream to the server of an Airport scalar function, with
+  // read_ahead the results are read on a background thread as they arrive
+  // rather than when they are asked for.
+  unique_ptr<AirportScalarFunctionLocalState> AirportScalarFunctionOpenStream(ClientContext &context, const BoundFunctionExpression &expr,
+                                                                              bool read_ahead = false);
+
   void AirportScalarFunctionProcessChunk(DataChunk &args, ExpressionState &state, Vector &result);
   unique_ptr<FunctionLocalState> AirportScalarFunctionInitLocalState(ExpressionState &state, const BoundFunctionExpression &expr, FunctionData *bind_data);
 
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include <atomic>
+#include <list>
+
+namespace duckdb
+{
+  // A process wide LRU cache of the results of remote scalar functions that
+  // their server declares as deterministic, so repeated calls with the same
+  // arguments (from other chunks, threads or queries) don't go over the
+  // network again.
+  //
+  // Results are keyed by the function (its location, name, the version the
+  // server gives it, its argument types and return type) and the bytes of
+  // the values of the arguments. The number of results kept is limited by
+  // the airport_scalar_function_cache_entries setting. The cache is shared,
+  // so setting it in one connection changes it for all of them.
+  static constexpr idx_t AIRPORT_DEFAULT_SCALAR_FUNCTION_CACHE_ENTRIES = 100000;
+
+  class AirportScalarFunctionCache
+  {
+  public:
+    // A function whose results are cached, along with its counters.
+    struct Function
+    {
+      string server_location;
+      string name;
+      string version;
+      LogicalType return_type;
+      string key;
+
+      idx_t entries = 0;
+      idx_t hits = 0;
+      idx_t misses = 0;
+    };
+
+    static AirportScalarFunctionCache &Get();
+
+    // Get the function, creating it if it hasn't been seen before.
+    shared_ptr<Function> GetFunction(const string &server_location,
+                                     const string &name,
+                                     const string &version,
+                                     const vector<LogicalType> &argument_types,
+                                     const LogicalType &return_type);
+
+    // The keys of the arguments in the rows of a chunk.
+    static void ArgumentsKeys(DataChunk &chunk, vector<string> &keys);
+
+    // Look up the results of the arguments into a flat vector of the
+    // function's return type, found is set for every result that was cached
+    // and the others are NULL. Returns the number of results that were found.
+    idx_t Lookup(Function &function, const vector<string> &arguments, Vector &results, vector<bool> &found);
+
+    // Add results, evicting the least recently used results of any
+    // function while there are more than the capacity.
+    void Insert(Function &function, const vector<string> &arguments, Vector &results);
+
+    // The number of results that are kept, 0 when the cache is disabled.
+    idx_t capacity() const
+    {
+      return capacity_;
+    }
+
+    static void SetCapacityOnSetting(ClientContext &context, SetScope scope, Value &parameter);
+
+    // A copy of the functions and their counters.
+    vector<Function> Functions();
+
+  private:
+    struct Entry
+    {
+      string key;
+      // The bytes of the result, nested results are kept as a value.
+      string result;
+      Value nested_result;
+      Function *function;
+    };
+
+    void Evict();
+
+    std::atomic<idx_t> capacity_{AIRPORT_DEFAULT_SCALAR_FUNCTION_CACHE_ENTRIES};
+    mutex lock_;
+    // The most recently used entries are at the front.
+    std::list<Entry> entries_;
+    std::unordered_map<string, std::list<Entry>::iterator> index_;
+    std::unordered_map<string, shared_ptr<Function>> functions_;
+  };
+
+  void AirportAddScalarFunctionCacheFunction(ExtensionLoader &loader);
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/execution/physical_operator.hpp"
+#include "duckdb/main/config.hpp"
+#include "duckdb/planner/operator/logical_extension_operator.hpp"
+
+namespace duckdb
+{
+  // A scalar function has to return the results of a chunk before it is
+  // given the next one, so an Airport scalar function called from a
+  // projection would wait for a round trip to the server for every chunk.
+  //
+  // The Airport scalar functions at the top of the expressions of a
+  // projection are instead evaluated by this operator, placed below the
+  // projection. It keeps up to airport_scalar_function_window chunks sent
+  // to the server before it reads the results of the oldest one, so the
+  // stream is limited by bandwidth and the server rather than latency.
+  //
+  // Servers can also declare a preferred batch size in the metadata of
+  // the input schema of a function, the chunks are then collected until
+  // there are that many rows and sent as a single record batch. The
+  // results are split back into the chunks they came from.
+  //
+  // The results of a DoExchange stream come back in the order the rows
+  // were sent, so they are matched to the chunks by position.
+  //
+  // Only the columns of the child that the projection uses are passed
+  // through, since every chunk in flight is held until its results arrive.
+  //
+  // Chunks leave the operator later than they came in, so when the sink
+  // of the pipeline needs the batch index or the order of the rows (an
+  // ORDER BY that has to be preserved, for instance) it falls back to
+  // sending a chunk and reading its results before taking the next.
+  class LogicalAirportScalarFunctionPipeline : public LogicalExtensionOperator
+  {
+  public:
+    LogicalAirportScalarFunctionPipeline(idx_t table_index, vector<unique_ptr<Expression>> functions, idx_t window, idx_t batch_rows);
+
+    //! The functions are the columns of this table index, after the columns of the child.
+    idx_t table_index;
+    //! The number of batches that are sent before waiting for results.
+    idx_t window;
+    //! The number of rows collected before a batch is sent.
+    idx_t batch_rows;
+    //! The columns of the child that are passed through, in order.
+    vector<idx_t> projection_map;
+
+    PhysicalOperator &CreatePlan(ClientContext &context, PhysicalPlanGenerator &planner) override;
+
+    vector<ColumnBinding> GetColumnBindings() override;
+
+    string GetExtensionName() const override
+    {
+      return "airport_scalar_function_pipeline";
+    }
+
+  protected:
+    void ResolveTypes() override;
+  };
+
+  class AirportScalarFunctionPipeline : public PhysicalOperator
+  {
+  public:
+    AirportScalarFunctionPipeline(PhysicalPlan &physical_plan,
+                                  vector<LogicalType> types,
+                                  vector<unique_ptr<Expression>> functions,
+                                  idx_t window,
+                                  idx_t batch_rows,
+                                  vector<idx_t> projection_map,
+                                  idx_t estimated_cardinality);
+
+    //! The Airport scalar function calls, their arguments refer to the columns of the child.
+    vector<unique_ptr<Expression>> functions;
+    //! The number of batches that are sent before waiting for results.
+    idx_t window;
+    //! The number of rows collected before a batch is sent.
+    idx_t batch_rows;
+    //! The columns of the child that are passed through, in order.
+    vector<idx_t> projection_map;
+
+  public:
+    unique_ptr<OperatorState> GetOperatorState(ExecutionContext &context) const override;
+
+    OperatorResultType Execute(ExecutionContext &context, DataChunk &input, DataChunk &chunk,
+                               GlobalOperatorState &gstate, OperatorState &state) const override;
+
+    OperatorFinalizeResultType FinalExecute(ExecutionContext &context, DataChunk &chunk,
+                                            GlobalOperatorState &gstate, OperatorState &state) const override;
+
+    bool ParallelOperator() const override
+    {
+      return true;
+    }
+
+    bool RequiresFinalExecute() const override
+    {
+      return true;
+    }
+
+    string GetName() const override;
+    InsertionOrderPreservingMap<string> ParamsToString() const override;
+  };
+
+  // Move the Airport scalar functions of projections into pipelines, when
+  // airport_scalar_function_window is more than 1 or the function prefers
+  // batches larger than a chunk.
+  void AirportPipelineScalarFunctions(OptimizerExtensionInput &input, unique_ptr<LogicalOperator> &plan);
+}
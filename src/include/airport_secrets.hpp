@@ -9,4 +9,10 @@ namespace duckdb
 
   string AirportAuthTokenForLocation(ClientContext &context, const string &server_location, const string &secret_name, const string &auth_token);
 
+  struct AirportFlightClientOptions;
+
+  // Read the gRPC transport options stored in the secret with the name, or
+  // if no name is given the secret that matches the location.
+  void AirportFlightClientOptionsFromSecret(ClientContext &context, const string &server_location, const string &secret_name, AirportFlightClientOptions &options);
+
 }
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include <arrow/flight/client.h>
+
+namespace duckdb
+{
+  // Register all of the DuckDB settings that control Airport's behavior.
+  void AirportAddSettings(ExtensionLoader &loader);
+
+  // Read an unsigned integer setting, returning the default value if the
+  // setting has not been registered or is NULL.
+  idx_t AirportGetUBigIntSetting(ClientContext &context, const string &name, const idx_t default_value);
+
+  bool AirportGetBooleanSetting(ClientContext &context, const string &name, const bool default_value);
+
+  // The maximum number of bytes of record batches that a single scan thread
+  // will read ahead from a DoGet stream, already clamped so that all scan
+  // threads together stay within a small share of DuckDB's memory_limit.
+  //
+  // A value of zero disables prefetching.
+  idx_t AirportScanPrefetchBytes(ClientContext &context);
+
+  // The limits on the size of the record batches that DML statements
+  // collect before writing them to an exchange, zero means every chunk is
+  // written on its own.
+  idx_t AirportWriteBatchRows(ClientContext &context);
+  idx_t AirportWriteBatchBytes(ClientContext &context);
+
+  // Apply the airport_ipc_compression setting to a Flight call. The server
+  // is asked to compress the batches it sends with the airport-ipc-compression
+  // header, and the write options of the call get the codec that should be
+  // used for batches sent to the server, so writers should be started with
+  // Begin(schema, call_options.write_options).
+  void AirportUseIpcCompression(ClientContext &context, arrow::flight::FlightCallOptions &call_options);
+}
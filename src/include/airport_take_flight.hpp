@@ -4,15 +4,59 @@
 #include "duckdb.hpp"
 
 #include "airport_flight_stream.hpp"
+#include <condition_variable>
+#include <mutex>
 
 namespace duckdb
 {
-  struct AirportArrowScanGlobalState : public GlobalTableFunctionState
+  // The stream of a single endpoint whose record batches are converted
+  // by many scan threads at once. Pulling the next batch is serialized but
+  // every exported batch owns its buffers, so ArrowToDuckDB can run on all
+  // of the threads that hold a batch in parallel.
+  class AirportSharedScanStream
   {
-    // idx_t batch_index = 0;
+  public:
+    explicit AirportSharedScanStream(shared_ptr<ArrowArrayStreamWrapper> stream, const idx_t endpoint_index)
+        : stream_(std::move(stream)), endpoint_index_(endpoint_index)
+    {
+    }
+
+    // Place the next non-empty chunk of the stream in the local state,
+    // returns false once the stream is exhausted. The position of the
+    // chunk in the stream is returned in sequence.
+    bool NextChunk(ArrowScanLocalState &state, idx_t &sequence);
+
+    bool finished() const
+    {
+      return finished_.load(std::memory_order_relaxed);
+    }
+
+    idx_t endpoint_index() const
+    {
+      return endpoint_index_;
+    }
 
+  private:
+    std::mutex lock_;
+    shared_ptr<ArrowArrayStreamWrapper> stream_;
+    const idx_t endpoint_index_;
+    idx_t next_sequence_ = 0;
+    std::atomic<bool> finished_ = false;
+  };
+
+  // Batch indexes are built from the endpoint index and the position of the
+  // batch in the endpoint's stream, so the order of the flight's endpoints is
+  // preserved. DuckDB requires source batch indexes to stay well below 10^13.
+  static constexpr idx_t AIRPORT_MAX_BATCHES_PER_ENDPOINT = 1ULL << 24;
+
+  struct AirportArrowScanGlobalState : public GlobalTableFunctionState
+  {
     idx_t MaxThreads() const override
     {
+      if (share_endpoint_streams_)
+      {
+        return max_threads_;
+      }
       return endpoints_.size();
     }
 
@@ -51,16 +95,58 @@ namespace duckdb
       return endpoints_.size();
     }
 
-    const std::optional<const flight::FlightEndpoint> GetNextEndpoint()
+    const std::optional<const flight::FlightEndpoint> GetNextEndpoint(idx_t &endpoint_index)
     {
+      if (share_endpoint_streams_)
+      {
+        // Count the endpoint as being opened before handing it out, so
+        // threads that look for a stream to share know to wait for it.
+        std::lock_guard<std::mutex> l(shared_streams_lock_);
+        size_t index = current_endpoint_.fetch_add(1, std::memory_order_relaxed);
+        if (index < endpoints_.size())
+        {
+          opening_endpoints_++;
+          endpoint_index = index;
+          return endpoints_[index];
+        }
+        return std::nullopt;
+      }
+
       size_t index = current_endpoint_.fetch_add(1, std::memory_order_relaxed);
       if (index < endpoints_.size())
       {
+        endpoint_index = index;
         return endpoints_[index];
       }
       return std::nullopt;
     }
 
+    // Used when there are fewer endpoints than threads, the threads that
+    // don't get an endpoint of their own help convert the batches of the
+    // endpoints that are already being read.
+    void enable_shared_endpoint_streams(const idx_t max_threads)
+    {
+      share_endpoint_streams_ = true;
+      max_threads_ = max_threads;
+    }
+
+    bool share_endpoint_streams() const
+    {
+      return share_endpoint_streams_;
+    }
+
+    // Called once for every endpoint returned by GetNextEndpoint, with the
+    // shared stream or nullptr if the endpoint can't be shared.
+    void EndpointOpened(shared_ptr<AirportSharedScanStream> stream);
+
+    // Find a stream that is still producing batches, waiting for the
+    // endpoints that are being opened. Returns nullptr when there is no
+    // work left to share.
+    //
+    // Only streams of endpoints at or after minimum_endpoint_index are
+    // returned, so the batch indexes seen by a thread keep increasing.
+    shared_ptr<AirportSharedScanStream> AttachSharedStream(const idx_t minimum_endpoint_index);
+
     const vector<idx_t> &projection_ids() const
     {
       return projection_ids_;
@@ -76,12 +162,33 @@ namespace duckdb
       return init_input_;
     }
 
+    // The number of bytes that had to be copied to align received batches
+    // for the whole scan, reported in the query profile.
+    atomic<idx_t> realigned_bytes = 0;
+
+    // The rows produced and the bytes of batches received by the scan, used
+    // to estimate progress when the server doesn't report it.
+    atomic<idx_t> rows_read = 0;
+    atomic<idx_t> bytes_read = 0;
+
+    // The number of endpoints skipped because of their statistics.
+    idx_t pruned_endpoints = 0;
+
   private:
     vector<flight::FlightEndpoint> endpoints_;
     std::atomic<size_t> current_endpoint_ = 0;
     const vector<idx_t> projection_ids_;
     const vector<LogicalType> scanned_types_;
     std::optional<TableFunctionInitInput> init_input_ = std::nullopt;
+
+    bool share_endpoint_streams_ = false;
+    idx_t max_threads_ = 1;
+
+    std::mutex shared_streams_lock_;
+    std::condition_variable shared_streams_cv_;
+    vector<shared_ptr<AirportSharedScanStream>> shared_streams_;
+    idx_t opening_endpoints_ = 0;
+    idx_t next_shared_stream_ = 0;
   };
 
   shared_ptr<ArrowArrayStreamWrapper> AirportProduceArrowScan(
@@ -112,6 +219,12 @@ namespace duckdb
 
   std::string AirportNameForField(const string &name, const idx_t col_idx);
 
+  // The client for a flight, flights of the tables of an attached database
+  // use the clients of that database.
+  std::shared_ptr<arrow::flight::FlightClient> AirportTakeFlightClient(ClientContext &context,
+                                                                       const AirportTakeFlightParameters &take_flight_params,
+                                                                       const AirportTableEntry *table_entry);
+
   void AirportTakeFlightComplexFilterPushdown(ClientContext &context, LogicalGet &get, FunctionData *bind_data_p,
                                               vector<unique_ptr<Expression>> &filters);
   unique_ptr<NodeStatistics> AirportTakeFlightCardinality(ClientContext &context, const FunctionData *data);
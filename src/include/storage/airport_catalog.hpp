@@ -4,15 +4,19 @@
 #include "duckdb/function/table_function.hpp"
 #include "duckdb/common/enums/access_mode.hpp"
 #include "storage/airport_schema_set.hpp"
+#include "airport_flight_client_pool.hpp"
 
 namespace duckdb
 {
   class AirportSchemaEntry;
+  class AirportTableEntry;
 
   struct AirportAttachParameters
   {
-    AirportAttachParameters(const string &location, const string &auth_token, const string &secret_name, const string &criteria)
-        : location_(location), auth_token_(auth_token), secret_name_(secret_name), criteria_(criteria)
+    AirportAttachParameters(const string &location, const string &auth_token, const string &secret_name, const string &criteria,
+                            const idx_t channel_count, const AirportFlightClientOptions &client_options)
+        : location_(location), auth_token_(auth_token), secret_name_(secret_name), criteria_(criteria),
+          channel_count_(channel_count), client_options_(client_options)
     {
     }
 
@@ -36,6 +40,16 @@ namespace duckdb
       return criteria_;
     }
 
+    idx_t channel_count() const
+    {
+      return channel_count_;
+    }
+
+    const AirportFlightClientOptions &client_options() const
+    {
+      return client_options_;
+    }
+
   private:
     // The location of the flight server.
     string location_;
@@ -45,6 +59,12 @@ namespace duckdb
     string secret_name_;
     // The criteria to pass to the flight server when listing flights.
     string criteria_;
+    // The number of channels opened to the location, from the settings
+    // when the database was attached.
+    idx_t channel_count_;
+    // The transport options of the clients of the database, from the
+    // settings, the secret and the ATTACH options.
+    AirportFlightClientOptions client_options_;
   };
 
   class AirportClearCacheFunction : public TableFunction
@@ -103,12 +123,27 @@ namespace duckdb
 
     void ClearCache();
 
+    // Look up a table without a catalog transaction, as a committing
+    // transaction no longer has one. Null if there is no such table.
+    optional_ptr<AirportTableEntry> LookupTable(ClientContext &context, const string &schema_name, const string &table_name);
+
     optional_idx GetCatalogVersion(ClientContext &context) override;
 
     std::optional<string> GetTransactionIdentifier();
 
-    // Track what version of the catalog has been loaded.
-    std::optional<AirportGetCatalogVersionResult> loaded_catalog_version;
+    // The version of the catalog that has been loaded, a copy since it is
+    // replaced whenever the catalog is reloaded.
+    std::optional<AirportGetCatalogVersionResult> loaded_catalog_version() const
+    {
+      lock_guard<mutex> guard(loaded_catalog_version_lock_);
+      return loaded_catalog_version_;
+    }
+
+    void set_loaded_catalog_version(const std::optional<AirportGetCatalogVersionResult> &version)
+    {
+      lock_guard<mutex> guard(loaded_catalog_version_lock_);
+      loaded_catalog_version_ = version;
+    }
 
     const string &internal_name() const
     {
@@ -129,11 +164,15 @@ namespace duckdb
     void DropSchema(ClientContext &context, DropInfo &info) override;
 
   private:
-    std::shared_ptr<arrow::flight::FlightClient> flight_client_;
     AccessMode access_mode_;
     std::shared_ptr<AirportAttachParameters> attach_parameters_;
     string internal_name_;
     AirportSchemaSet schemas;
     string default_schema;
+
+    // Track what version of the catalog has been loaded, it is read by
+    // transactions and written by reloads on other threads.
+    mutable mutex loaded_catalog_version_lock_;
+    std::optional<AirportGetCatalogVersionResult> loaded_catalog_version_;
   };
 }
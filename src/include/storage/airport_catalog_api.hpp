@@ -12,6 +12,7 @@
 namespace duckdb
 {
   struct AirportAttachParameters;
+  class ClientContext;
 
   struct AirportSerializedCatalogSchemaRequest
   {
@@ -63,7 +64,10 @@ namespace duckdb
   {
     uint64_t catalog_version;
     bool is_fixed;
-    MSGPACK_DEFINE_MAP(catalog_version, is_fixed)
+    // Set to false by servers that don't use transactions, so the
+    // create_transaction action is never called.
+    std::optional<bool> uses_transactions;
+    MSGPACK_DEFINE_MAP(catalog_version, is_fixed, uses_transactions)
   };
 
   struct AirportSerializedCatalogRoot
@@ -404,7 +408,15 @@ namespace duckdb
                                                            const string &catalog_name,
                                                            const string &baseDir);
 
-    static std::shared_ptr<arrow::flight::FlightClient> FlightClientForLocation(const std::string &location);
+    // A client for a location that isn't reached through an attached
+    // database, the settings of the context and the secret (the named one
+    // or the one for the location) decide how it connects.
+    static std::shared_ptr<arrow::flight::FlightClient> FlightClientForLocation(ClientContext &context, const std::string &location,
+                                                                                const std::string &secret_name);
+
+    // A client for an attached database, it connects the way that was
+    // decided when the database was attached.
+    static std::shared_ptr<arrow::flight::FlightClient> FlightClientForLocation(const AirportAttachParameters &attach_parameters);
 
     // The the rowid column type, LogicalType::SQLNULL if none is present.
     static LogicalType GetRowIdType(ClientContext &context,
@@ -4,6 +4,9 @@
 
 namespace duckdb
 {
+  class AirportExchangeGlobalState;
+  class AirportTableEntry;
+
   class AirportDelete : public PhysicalOperator
   {
   public:
@@ -13,6 +16,10 @@ namespace duckdb
     TableCatalogEntry &table;
     idx_t rowid_index;
     bool return_chunk;
+    //! Each thread writes to its own DoExchange stream.
+    bool parallel_exchange = false;
+    //! The row ids are sent as sorted ranges.
+    bool rowid_ranges = false;
 
   public:
     // Source interface
@@ -31,6 +38,7 @@ namespace duckdb
     unique_ptr<GlobalSourceState> GetGlobalSourceState(ClientContext &context) const override;
 
     SinkResultType Sink(ExecutionContext &context, DataChunk &chunk, OperatorSinkInput &input) const override;
+    SinkCombineResultType Combine(ExecutionContext &context, OperatorSinkCombineInput &input) const override;
     SinkFinalizeType Finalize(Pipeline &pipeline, Event &event, ClientContext &context,
                               OperatorSinkFinalizeInput &input) const override;
 
@@ -41,11 +49,14 @@ namespace duckdb
 
     bool ParallelSink() const override
     {
-      return false;
+      return parallel_exchange;
     }
 
     string GetName() const override;
     InsertionOrderPreservingMap<string> ParamsToString() const override;
+
+  private:
+    void OpenExchange(ClientContext &context, AirportTableEntry &airport_table, AirportExchangeGlobalState &exchange) const;
   };
 
 } // namespace duckdb
@@ -11,7 +11,8 @@ namespace duckdb
 
     //! The table to delete from
     TableCatalogEntry &table;
-    string sql_filters;
+    //! The filters of the delete, serialized when they were pushed down to the scan
+    string json_filters;
 
   public:
     bool IsSource() const override
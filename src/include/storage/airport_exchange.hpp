@@ -2,13 +2,21 @@
 
 #include "duckdb.hpp"
 #include "duckdb/function/table/arrow.hpp"
+#include "duckdb/common/arrow/arrow_appender.hpp"
+#include "duckdb/common/error_data.hpp"
 #include "airport_flight_stream.hpp"
 #include "airport_take_flight.hpp"
 #include "airport_table_entry.hpp"
 #include "airport_schema_utils.hpp"
+#include <arrow/filesystem/filesystem.h>
+#include <arrow/io/interfaces.h>
+#include <arrow/ipc/writer.h>
+#include <functional>
+#include <thread>
 
 namespace duckdb
 {
+  class PhysicalTableScan;
 
   struct AirportExchangeTakeFlightBindData : public AirportTakeFlightBindData
   {
@@ -69,6 +77,84 @@ namespace duckdb
     vector<LogicalType> return_types_;
   };
 
+  class AirportExchangeGlobalState;
+
+  // Reads the rows the server returns on an exchange (for RETURNING) on a
+  // thread of its own, so batches can be written without waiting for the
+  // rows that belong to them. The server is free to return the rows in
+  // whatever batches it likes.
+  //
+  // The stream ends with the message that has the final metadata.
+  class AirportExchangeReturnReader
+  {
+  public:
+    // Called on the reader's thread for every chunk of returned rows, the
+    // chunk is only valid during the call.
+    using append_t = std::function<void(DataChunk &chunk)>;
+
+    AirportExchangeReturnReader(ClientContext &context,
+                                AirportExchangeGlobalState &exchange,
+                                const vector<LogicalType> &types,
+                                append_t append);
+
+    ~AirportExchangeReturnReader();
+
+    // Wait for the server to end the stream, throws the error the reader
+    // ran into if there was one.
+    void Join();
+
+    const std::shared_ptr<arrow::Buffer> &final_metadata() const
+    {
+      return final_metadata_;
+    }
+
+  private:
+    void Run();
+
+    ClientContext &context_;
+    AirportExchangeGlobalState &exchange_;
+    const vector<LogicalType> types_;
+    const append_t append_;
+
+    std::shared_ptr<arrow::Buffer> final_metadata_;
+    ErrorData error_;
+    // Set once the thread has stopped reading.
+    std::atomic<bool> finished_ = false;
+
+    // Started last, once everything else is set.
+    std::thread thread_;
+  };
+
+  // A file the rows of an insert were staged to. It is removed when this is
+  // destroyed (the insert failed or was cancelled) unless it was released
+  // once the server took it.
+  class AirportStagedFile
+  {
+  public:
+    AirportStagedFile(std::shared_ptr<arrow::fs::FileSystem> file_system, const string &path, const string &uri)
+        : file_system_(std::move(file_system)), path_(path), uri_(uri)
+    {
+    }
+    ~AirportStagedFile();
+
+    const string &uri() const
+    {
+      return uri_;
+    }
+
+    // The server owns the file now.
+    void Release()
+    {
+      released_ = true;
+    }
+
+  private:
+    const std::shared_ptr<arrow::fs::FileSystem> file_system_;
+    const string path_;
+    const string uri_;
+    bool released_ = false;
+  };
+
   // This is all of the state is needed to perform a ArrowScan on a resulting
   // DoExchange stream, this is useful for having RETURNING data work for
   // INSERT, DELETE or UPDATE.
@@ -88,6 +174,64 @@ namespace duckdb
 
     vector<LogicalType> send_types;
     vector<string> send_names;
+
+    // Set instead of the scan state when rows are inserted with DoPut.
+    std::unique_ptr<arrow::flight::FlightMetadataReader> put_reader;
+
+    // Set instead of the writer when the rows of an insert are staged to
+    // a file. The file is declared first so it is removed after the stream
+    // writing it is closed.
+    unique_ptr<AirportStagedFile> staged_file;
+    std::shared_ptr<arrow::io::OutputStream> staged_output;
+    std::shared_ptr<arrow::ipc::RecordBatchWriter> staged_writer;
+
+    // Where the record batches sent to the server are written.
+    arrow::ipc::RecordBatchWriter &batch_writer()
+    {
+      if (staged_writer)
+      {
+        return *staged_writer;
+      }
+      return *writer;
+    }
+
+    // Set when the returned rows are read on their own thread, this is
+    // last so the thread is stopped before the scan state goes away.
+    unique_ptr<AirportExchangeReturnReader> return_reader;
+  };
+
+  // Collects the chunks sent on an exchange so they are written as a few
+  // large record batches rather than one batch of at most 2048 rows per
+  // chunk, every IPC message has a cost on both sides of the stream.
+  //
+  // The server sees the batches rather than the chunks, so any rows it
+  // returns have to be read by an AirportExchangeReturnReader.
+  class AirportExchangeWriteBuffer
+  {
+  public:
+    AirportExchangeWriteBuffer(ClientContext &context, const vector<LogicalType> &types);
+
+    // Add the rows of the chunk, returns true when the buffer is full
+    // and should be flushed.
+    bool Append(DataChunk &chunk);
+
+    // Write the buffered rows to the exchange as one record batch.
+    void Flush(const AirportTableEntry &table, AirportExchangeGlobalState &exchange);
+
+    idx_t row_count() const
+    {
+      return row_count_;
+    }
+
+  private:
+    ClientContext &context_;
+    const vector<LogicalType> types_;
+    const idx_t max_rows_;
+    const idx_t max_bytes_;
+
+    unique_ptr<ArrowAppender> appender_;
+    idx_t row_count_ = 0;
+    idx_t byte_count_ = 0;
   };
 
   void AirportExchangeGetGlobalSinkState(ClientContext &context,
@@ -98,5 +242,91 @@ namespace duckdb
                                          const bool return_chunk,
                                          const string exchange_operation,
                                          const vector<string> returning_column_names,
-                                         const std::optional<string> transaction_id);
-}
\ No newline at end of file
+                                         const std::optional<string> transaction_id,
+                                         const std::shared_ptr<const arrow::KeyValueMetadata> &send_metadata = nullptr);
+
+  // Start a DoPut of rows to insert into a table, nothing is read back
+  // other than the PutResult metadata that has the final count.
+  void AirportPutGetGlobalSinkState(ClientContext &context,
+                                    const AirportTableEntry &airport_table,
+                                    AirportExchangeGlobalState *global_state,
+                                    const ArrowSchema &send_schema,
+                                    const std::optional<string> transaction_id);
+
+  // Servers declare that a table can be written to by several DoExchange
+  // streams at once by setting the "parallel_exchange" key of the table's
+  // schema metadata to "true" (or "1"). Each stream carries the same
+  // transaction id and ends with its own final metadata message.
+  //
+  // The airport_parallel_exchange setting can turn this off.
+  bool AirportExchangeSupportsParallelStreams(ClientContext &context, const AirportTableEntry &table);
+
+  // Servers declare that a DELETE can send the row ids of a table as
+  // ranges by setting the "rowid_ranges" key of the table's schema metadata
+  // to "true" (or "1"), the exchange then has the columns rowid_start and
+  // rowid_end (both BIGINT and inclusive) rather than rowid. Only tables
+  // with integer row ids that fit in a BIGINT can use this.
+  //
+  // The airport_delete_rowid_ranges setting can turn this off.
+  bool AirportTableSupportsRowIdRanges(ClientContext &context, const AirportTableEntry &table);
+
+  // Servers declare they can insert rows into a table from files by
+  // setting the "staged_ingest" key of the table's schema metadata to
+  // "true" (or "1"). When the airport_ingest_staging_uri setting is also
+  // set, INSERT and CREATE TABLE AS without RETURNING write Arrow IPC files
+  // under that location (any URI Arrow's filesystems understand, or a
+  // local path) and then pass the list of files to the server with the
+  // ingest_staged_files action. The server owns the files after that.
+  bool AirportTableSupportsStagedIngest(ClientContext &context, const AirportTableEntry &table, string &staging_uri);
+
+  // Start a new staged file for the rows of an insert.
+  void AirportStagedIngestGetGlobalSinkState(ClientContext &context,
+                                             const AirportTableEntry &airport_table,
+                                             AirportExchangeGlobalState *global_state,
+                                             const ArrowSchema &send_schema,
+                                             const string &staging_uri);
+
+  // Call the ingest_staged_files action for the files, returns the
+  // result of the action which has the final metadata of the insert.
+  std::shared_ptr<arrow::Buffer> AirportIngestStagedFiles(ClientContext &context,
+                                                          const AirportTableEntry &airport_table,
+                                                          const vector<string> &uris,
+                                                          const std::optional<string> transaction_id);
+
+  // Servers declare that rows can be inserted into a table with DoPut, when
+  // there is no RETURNING, by setting the "put_ingest" key of the table's
+  // schema metadata to "true" (or "1"). DoPut streams are independent, so
+  // each thread of the insert gets its own.
+  //
+  // The airport_put_ingest setting can turn this off.
+  bool AirportTableSupportsPutIngest(ClientContext &context, const AirportTableEntry &table);
+
+  // Find the scan of an UPDATE or DELETE of a table without row ids, only
+  // filters and projections can be between the scan and the statement.
+  // has_filter is set if there is a filter.
+  PhysicalTableScan &AirportParameterizedScan(PhysicalOperator &child, const string &statement, bool &has_filter);
+
+  // The filters of an UPDATE or DELETE of a table without row ids, these
+  // were serialized with the AirportJsonSerializer when they were pushed
+  // down to the scan.
+  string AirportParameterizedFilters(PhysicalOperator &child, const string &statement);
+
+  // Perform an UPDATE or DELETE of a table without row ids with a single
+  // call of the parameterized_update or parameterized_delete action, the
+  // server applies the filters (and the SET expressions of an update) to
+  // the table itself. Returns the result of the action which has the same
+  // msgpack encoded final metadata as the DoExchange of the operation.
+  std::shared_ptr<arrow::Buffer> AirportParameterizedDML(ClientContext &context,
+                                                         const AirportTableEntry &airport_table,
+                                                         const string &operation,
+                                                         const string &json_filters,
+                                                         const string &json_expressions,
+                                                         const std::optional<string> transaction_id);
+
+  // Indicate that writing to the stream of the exchange is done and read
+  // the app_metadata the server sends at the end of it (or the metadata
+  // of the last PutResult of a DoPut), returns nullptr if the server didn't
+  // send any. A staged file is just closed.
+  std::shared_ptr<arrow::Buffer> AirportExchangeFinish(const AirportTableEntry &table,
+                                                       AirportExchangeGlobalState &exchange);
+}
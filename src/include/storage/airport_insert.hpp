@@ -3,12 +3,16 @@
 #include "duckdb/execution/physical_operator.hpp"
 #include "duckdb/common/index_vector.hpp"
 #include "duckdb/parser/statement/insert_statement.hpp"
+#include "duckdb/common/types/column/column_data_collection.hpp"
+#include <optional>
 
 namespace duckdb
 {
 
   class AirportInsertGlobalState;
   class AirportInsertLocalState;
+  class AirportExchangeGlobalState;
+  class AirportTableEntry;
   class AirportInsert : public PhysicalOperator
   {
   public:
@@ -41,13 +45,21 @@ namespace duckdb
 
     bool return_chunk;
 
+    //! Each thread writes to its own stream (DoExchange, DoPut or staged file).
+    bool parallel_exchange = false;
+
+    //! The rows are held by the transaction and sent when it commits.
+    bool write_behind = false;
+
     //! The default expressions of the columns for which no value is provided
     vector<unique_ptr<Expression>> bound_defaults;
     //! The bound constraints for the table
     vector<unique_ptr<BoundConstraint>> bound_constraints;
 
-    // For now always just throw errors.
+    //! ON CONFLICT DO NOTHING/UPDATE are applied by the server
     OnConflictAction action_type = OnConflictAction::THROW;
+    //! The serialized ON CONFLICT clause, sent in the schema metadata of the exchange
+    string on_conflict;
 
   public:
     // Source interface
@@ -70,6 +82,8 @@ namespace duckdb
                                 const physical_index_vector_t<idx_t> &column_index_map,
                                 ExpressionExecutor &default_executor, DataChunk &result);
 
+    void OpenExchange(ClientContext &context, AirportTableEntry &table, AirportExchangeGlobalState &exchange) const;
+
   public:
     // Sink interface
     unique_ptr<GlobalSinkState> GetGlobalSinkState(ClientContext &context) const override;
@@ -78,6 +92,7 @@ namespace duckdb
     unique_ptr<GlobalSourceState> GetGlobalSourceState(ClientContext &context) const override;
 
     SinkResultType Sink(ExecutionContext &context, DataChunk &chunk, OperatorSinkInput &input) const override;
+    SinkCombineResultType Combine(ExecutionContext &context, OperatorSinkCombineInput &input) const override;
     SinkFinalizeType Finalize(Pipeline &pipeline, Event &event, ClientContext &context,
                               OperatorSinkFinalizeInput &input) const override;
 
@@ -88,11 +103,18 @@ namespace duckdb
 
     bool ParallelSink() const override
     {
-      return false;
+      return parallel_exchange || write_behind;
     }
 
     string GetName() const override;
     InsertionOrderPreservingMap<string> ParamsToString() const override;
   };
 
+  // Insert rows that were held by a transaction (see airport_write_behind)
+  // with a single DoExchange, returns the number of rows inserted.
+  idx_t AirportInsertBufferedRows(ClientContext &context,
+                                  AirportTableEntry &table,
+                                  ColumnDataCollection &rows,
+                                  const std::optional<string> &transaction_id);
+
 }
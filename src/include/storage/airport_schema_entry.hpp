@@ -9,6 +9,7 @@
 namespace duckdb
 {
   class AirportTransaction;
+  class AirportTableEntry;
 
   class AirportSchemaEntry : public SchemaCatalogEntry
   {
@@ -42,6 +43,9 @@ namespace duckdb
 
     optional_ptr<CatalogEntry> LookupEntry(CatalogTransaction transaction, const EntryLookupInfo &lookup_info) override;
 
+    // Look up a table by name, null if there is no such table.
+    optional_ptr<AirportTableEntry> LookupTable(ClientContext &context, const string &name);
+
     const AirportSerializedContentsWithSHA256Hash &serialized_source() const
     {
       return schema_data_.source();
@@ -3,6 +3,7 @@
 #include "airport_extension.hpp"
 #include "airport_catalog.hpp"
 #include "duckdb/transaction/transaction.hpp"
+#include "duckdb/common/types/column/column_data_collection.hpp"
 
 namespace duckdb
 {
@@ -24,9 +25,18 @@ namespace duckdb
     ~AirportTransaction() override;
 
     void Start();
-    void Commit();
+    // Sends any buffered inserts before the transaction is done.
+    void Commit(ClientContext &context);
     void Rollback();
 
+    // Hold the rows of an INSERT until the transaction commits, the table
+    // is read or enough rows are buffered (write-behind), returns the
+    // number of rows that were added.
+    idx_t BufferInsert(ClientContext &context, AirportTableEntry &table, DataChunk &chunk);
+
+    // Send the buffered inserts of a table (or of all tables) to the server.
+    void FlushBufferedInserts(ClientContext &context, optional_ptr<const AirportTableEntry> table = nullptr);
+
     //	UCConnection &GetConnection();
     //	unique_ptr<UCResult> Query(const string &query);
     static AirportTransaction &Get(ClientContext &context, Catalog &catalog);
@@ -35,19 +45,37 @@ namespace duckdb
       return access_mode_;
     }
 
-    // The identifier returned from the Arrow flight server.
-    const std::optional<std::string> &identifier() const
-    {
-      return identifier_;
-    }
+    // The identifier returned from the Arrow flight server, the
+    // create_transaction action is only called the first time this is
+    // needed, so statements that never reach the server don't pay for it.
+    const std::optional<std::string> &identifier() const;
 
     vector<unique_ptr<CatalogEntry>> point_in_time_entries_;
 
   private:
     // The identifier returned from the Arrow flight server.
-    std::optional<std::string> identifier_;
+    mutable std::optional<std::string> identifier_;
+    mutable bool identifier_requested_ = false;
+    // Parallel sinks can all ask for the identifier at once.
+    mutable mutex identifier_lock_;
+
+    std::optional<std::string> GetTransactionIdentifier() const;
+
+    // The table is kept by name, since its entry can be freed by a DROP,
+    // ALTER or cache clear before the rows are sent.
+    struct BufferedInserts
+    {
+      string schema_name;
+      string table_name;
+      vector<string> column_names;
+      unique_ptr<ColumnDataCollection> rows;
+
+      bool IsFor(const AirportTableEntry &table) const;
+    };
 
-    std::optional<std::string> GetTransactionIdentifier();
+    // The buffered inserts in the order the tables were first written.
+    vector<BufferedInserts> buffered_inserts_;
+    mutex buffered_inserts_lock_;
 
     AirportTransactionState transaction_state = AirportTransactionState::TRANSACTION_NOT_YET_STARTED;
     AccessMode access_mode_;
@@ -5,6 +5,8 @@
 
 namespace duckdb
 {
+  class AirportExchangeGlobalState;
+  class AirportTableEntry;
 
   class AirportUpdate : public PhysicalOperator
   {
@@ -32,6 +34,8 @@ namespace duckdb
     bool update_is_del_and_insert;
     //! If the returning statement is present, return the whole chunk
     bool return_chunk;
+    //! Each thread writes to its own DoExchange stream.
+    bool parallel_exchange = false;
 
   public:
     // Source interface
@@ -50,6 +54,7 @@ namespace duckdb
     unique_ptr<GlobalSourceState> GetGlobalSourceState(ClientContext &context) const override;
 
     SinkResultType Sink(ExecutionContext &context, DataChunk &chunk, OperatorSinkInput &input) const override;
+    SinkCombineResultType Combine(ExecutionContext &context, OperatorSinkCombineInput &input) const override;
     SinkFinalizeType Finalize(Pipeline &pipeline, Event &event, ClientContext &context,
                               OperatorSinkFinalizeInput &input) const override;
 
@@ -60,13 +65,15 @@ namespace duckdb
 
     bool ParallelSink() const override
     {
-      return false;
+      return parallel_exchange;
     }
 
     string GetName() const override;
     InsertionOrderPreservingMap<string> ParamsToString() const override;
 
   private:
+    void OpenExchange(ClientContext &context, AirportTableEntry &airport_table, AirportExchangeGlobalState &exchange) const;
+
     vector<LogicalType> send_types;
     // This is a list of all column names that will be send
     vector<string> send_names;
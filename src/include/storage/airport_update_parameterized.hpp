@@ -7,11 +7,14 @@ namespace duckdb
   class AirportUpdateParameterized : public PhysicalOperator
   {
   public:
-    AirportUpdateParameterized(PhysicalPlan &physical_plan, LogicalOperator &op, TableCatalogEntry &table, PhysicalOperator &plan);
+    AirportUpdateParameterized(PhysicalPlan &physical_plan, ClientContext &context, LogicalOperator &op, TableCatalogEntry &table, PhysicalOperator &plan);
 
-    //! The table to delete from
+    //! The table to update
     TableCatalogEntry &table;
-    string sql_filters;
+    //! The filters of the update, serialized when they were pushed down to the scan
+    string json_filters;
+    //! The serialized SET expressions
+    string json_expressions;
 
   public:
     bool IsSource() const override
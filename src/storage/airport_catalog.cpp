@@ -25,7 +25,6 @@ namespace duckdb
       : Catalog(db_p), access_mode_(access_mode), attach_parameters_(std::make_shared<AirportAttachParameters>(std::move(attach_params))),
         internal_name_(internal_name), schemas(*this)
   {
-    flight_client_ = AirportAPI::FlightClientForLocation(this->attach_parameters_->location());
   }
 
   AirportCatalog::~AirportCatalog() = default;
@@ -42,9 +41,10 @@ namespace duckdb
 
   optional_idx AirportCatalog::GetCatalogVersion(ClientContext &context)
   {
-    if (loaded_catalog_version.has_value() && loaded_catalog_version.value().is_fixed)
+    const auto loaded_version = loaded_catalog_version();
+    if (loaded_version.has_value() && loaded_version->is_fixed)
     {
-      return loaded_catalog_version.value().catalog_version;
+      return loaded_version->catalog_version;
     }
 
     arrow::flight::FlightCallOptions call_options;
@@ -60,8 +60,11 @@ namespace duckdb
 
     AIRPORT_MSGPACK_ACTION_SINGLE_PARAMETER(action, "catalog_version", params);
 
+    // Lease a client for the call only, so it doesn't count as in use for
+    // as long as the database is attached.
+    auto flight_client = AirportAPI::FlightClientForLocation(*attach_parameters_);
     AIRPORT_ASSIGN_OR_RAISE_LOCATION(auto action_results,
-                                     flight_client_->DoAction(call_options, action),
+                                     flight_client->DoAction(call_options, action),
                                      server_location,
                                      "calling catalog_version action");
 
@@ -76,7 +79,7 @@ namespace duckdb
                            server_location,
                            "File to parse msgpack encoded catalog_version response");
 
-    loaded_catalog_version = result;
+    set_loaded_catalog_version(result);
 
     return result.catalog_version;
   }
@@ -133,6 +136,16 @@ namespace duckdb
     return reinterpret_cast<SchemaCatalogEntry *>(entry.get());
   }
 
+  optional_ptr<AirportTableEntry> AirportCatalog::LookupTable(ClientContext &context, const string &schema_name, const string &table_name)
+  {
+    auto schema = schemas.GetEntry(context, EntryLookupInfo(CatalogType::SCHEMA_ENTRY, schema_name));
+    if (!schema)
+    {
+      return nullptr;
+    }
+    return schema->Cast<AirportSchemaEntry>().LookupTable(context, table_name);
+  }
+
   bool AirportCatalog::InMemory()
   {
     return false;
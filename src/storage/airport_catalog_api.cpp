@@ -19,6 +19,7 @@
 
 #include "duckdb/common/file_system.hpp"
 
+#include "airport_flight_client_pool.hpp"
 #include "airport_macros.hpp"
 #include "airport_secrets.hpp"
 #include "airport_request_headers.hpp"
@@ -104,25 +105,23 @@ namespace duckdb
     throw NotImplementedException("AirportAPI::GetCatalogs");
   }
 
-  static std::unordered_map<std::string, std::shared_ptr<flight::FlightClient>> airport_flight_clients_by_location;
-  static std::mutex airport_clients_mutex;
-
-  std::shared_ptr<flight::FlightClient> AirportAPI::FlightClientForLocation(const std::string &location)
+  std::shared_ptr<flight::FlightClient> AirportAPI::FlightClientForLocation(ClientContext &context, const std::string &location,
+                                                                            const std::string &secret_name)
   {
-    std::lock_guard<std::mutex> lock(airport_clients_mutex);
-    auto it = airport_flight_clients_by_location.find(location);
-    if (it != airport_flight_clients_by_location.end())
-    {
-      return it->second;
-    }
-
-    AIRPORT_ASSIGN_OR_RAISE_LOCATION(auto parsed_location,
-                                     flight::Location::Parse(location), location, "");
-    AIRPORT_ASSIGN_OR_RAISE_LOCATION(airport_flight_clients_by_location[location],
-                                     flight::FlightClient::Connect(parsed_location),
-                                     location, "");
+    auto client_options = AirportFlightClientOptionsFromSettings(context);
+    AirportFlightClientOptionsFromSecret(context, location, secret_name, client_options);
+    return AirportFlightClientPoolForLocation(location,
+                                              AirportFlightChannelsPerLocation(context),
+                                              client_options)
+        ->Acquire();
+  }
 
-    return airport_flight_clients_by_location[location];
+  std::shared_ptr<flight::FlightClient> AirportAPI::FlightClientForLocation(const AirportAttachParameters &attach_parameters)
+  {
+    return AirportFlightClientPoolForLocation(attach_parameters.location(),
+                                              attach_parameters.channel_count(),
+                                              attach_parameters.client_options())
+        ->Acquire();
   }
 
   static size_t GetRequestWriteCallback(void *contents, size_t size, size_t nmemb, void *userp)
@@ -582,7 +581,7 @@ namespace duckdb
 
       airport_add_authorization_header(call_options, credentials->auth_token());
 
-      auto flight_client = FlightClientForLocation(credentials->location());
+      auto flight_client = FlightClientForLocation(*credentials);
 
       AIRPORT_ASSIGN_OR_RAISE_LOCATION(auto listing, flight_client->ListFlights(call_options, {credentials->criteria()}), server_location, "");
 
@@ -648,7 +647,7 @@ namespace duckdb
 
     call_options.headers.emplace_back("airport-action-name", "list_schemas");
 
-    auto flight_client = FlightClientForLocation(credentials->location());
+    auto flight_client = FlightClientForLocation(*credentials);
 
     AirportSerializedCatalogSchemaRequest catalog_request = {catalog_name};
 
@@ -59,7 +59,7 @@ namespace duckdb
     airport_add_standard_headers(call_options, airport_catalog.attach_parameters()->location());
     airport_add_authorization_header(call_options, airport_catalog.attach_parameters()->auth_token());
 
-    auto flight_client = AirportAPI::FlightClientForLocation(airport_catalog.attach_parameters()->location());
+    auto flight_client = AirportAPI::FlightClientForLocation(*airport_catalog.attach_parameters());
 
     // Common parameters
     DropItemActionParameters params;
@@ -21,6 +21,8 @@
 #include "airport_flight_stream.hpp"
 #include "airport_take_flight.hpp"
 #include "storage/airport_exchange.hpp"
+#include "airport_settings.hpp"
+#include "duckdb/common/vector_operations/vector_operations.hpp"
 
 // Some improvements to make
 //
@@ -66,12 +68,15 @@ namespace duckdb
   class AirportDeleteLocalState : public LocalSinkState
   {
   public:
-    AirportDeleteLocalState(ClientContext &context, TableCatalogEntry &table)
-    //                            const vector<unique_ptr<BoundConstraint>> &bound_constraints)
-    {
-      delete_chunk.Initialize(Allocator::Get(context), table.GetTypes());
-    }
-    DataChunk delete_chunk;
+    // The stream of this thread, only used when the table supports
+    // parallel exchanges.
+    unique_ptr<AirportExchangeGlobalState> exchange;
+
+    // The row ids waiting to be sent.
+    unique_ptr<AirportExchangeWriteBuffer> write_buffer;
+
+    // The row ids collected to be sent as ranges.
+    vector<int64_t> rowids;
   };
 
   class AirportDeleteGlobalState : public GlobalSinkState, public AirportExchangeGlobalState
@@ -93,6 +98,11 @@ namespace duckdb
     bool return_chunk;
 
     AirportTableEntry &table;
+
+    // The returned rows are added by the reader threads of the exchanges,
+    // this doesn't use delete_lock since a writer can hold that while it
+    // waits for the server to accept a batch.
+    mutex return_lock;
     ColumnDataCollection return_collection;
 
     void Flush(ClientContext &context)
@@ -100,19 +110,25 @@ namespace duckdb
     }
   };
 
-  unique_ptr<GlobalSinkState> AirportDelete::GetGlobalSinkState(ClientContext &context) const
+  void AirportDelete::OpenExchange(ClientContext &context, AirportTableEntry &airport_table, AirportExchangeGlobalState &exchange) const
   {
-    auto &airport_table = table.Cast<AirportTableEntry>();
-
-    auto delete_global_state = make_uniq<AirportDeleteGlobalState>(context, airport_table, GetTypes(), return_chunk);
-
     auto &transaction = AirportTransaction::Get(context, table.catalog);
 
-    delete_global_state->send_types = {airport_table.GetRowIdType()};
-    vector<string> send_names = {"rowid"};
+    vector<string> send_names;
+    if (rowid_ranges)
+    {
+      // Each row is a range of row ids, both ends are included.
+      exchange.send_types = {LogicalType::BIGINT, LogicalType::BIGINT};
+      send_names = {"rowid_start", "rowid_end"};
+    }
+    else
+    {
+      exchange.send_types = {airport_table.GetRowIdType()};
+      send_names = {"rowid"};
+    }
     ArrowSchema send_schema;
     auto client_properties = context.GetClientProperties();
-    ArrowConverter::ToArrowSchema(&send_schema, delete_global_state->send_types, send_names,
+    ArrowConverter::ToArrowSchema(&send_schema, exchange.send_types, send_names,
                                   client_properties);
 
     vector<string> returning_column_names;
@@ -122,16 +138,122 @@ namespace duckdb
       returning_column_names.push_back(cd.GetName());
     }
 
-    AirportExchangeGetGlobalSinkState(context, table, airport_table, delete_global_state.get(), send_schema, return_chunk, "delete",
+    AirportExchangeGetGlobalSinkState(context, table, airport_table, &exchange, send_schema, return_chunk, "delete",
                                       returning_column_names,
                                       transaction.identifier());
+  }
+
+  // The deleted rows are read from the exchange while the row ids are
+  // still being written to it.
+  static void AirportDeleteReadReturnedRows(ClientContext &context,
+                                            AirportDeleteGlobalState &gstate,
+                                            AirportExchangeGlobalState &exchange)
+  {
+    exchange.return_reader = make_uniq<AirportExchangeReturnReader>(
+        context, exchange, gstate.table.GetTypes(),
+        [&gstate](DataChunk &returned)
+        {
+          lock_guard<mutex> return_guard(gstate.return_lock);
+          gstate.return_collection.Append(returned);
+        });
+  }
+
+  static void AirportDeleteFlush(AirportDeleteGlobalState &gstate, AirportDeleteLocalState &ustate)
+  {
+    if (ustate.exchange)
+    {
+      ustate.write_buffer->Flush(gstate.table, *ustate.exchange);
+      return;
+    }
+    lock_guard<mutex> delete_guard(gstate.delete_lock);
+    ustate.write_buffer->Flush(gstate.table, gstate);
+  }
+
+  // Sort the collected row ids and send them as ranges of consecutive
+  // row ids, deletes usually cover runs of rows so this is much smaller
+  // than the row ids themselves.
+  static void AirportDeleteFlushRowIdRanges(ClientContext &context, AirportDeleteGlobalState &gstate, AirportDeleteLocalState &ustate)
+  {
+    auto &rowids = ustate.rowids;
+    if (rowids.empty())
+    {
+      return;
+    }
+    std::sort(rowids.begin(), rowids.end());
+    rowids.erase(std::unique(rowids.begin(), rowids.end()), rowids.end());
+
+    DataChunk ranges;
+    ranges.Initialize(context, {LogicalType::BIGINT, LogicalType::BIGINT});
+    auto range_starts = FlatVector::GetData<int64_t>(ranges.data[0]);
+    auto range_ends = FlatVector::GetData<int64_t>(ranges.data[1]);
+    idx_t range_count = 0;
+
+    auto add_range = [&](int64_t start, int64_t end)
+    {
+      range_starts[range_count] = start;
+      range_ends[range_count] = end;
+      range_count++;
+      if (range_count == STANDARD_VECTOR_SIZE)
+      {
+        ranges.SetCardinality(range_count);
+        if (ustate.write_buffer->Append(ranges))
+        {
+          AirportDeleteFlush(gstate, ustate);
+        }
+        ranges.Reset();
+        range_starts = FlatVector::GetData<int64_t>(ranges.data[0]);
+        range_ends = FlatVector::GetData<int64_t>(ranges.data[1]);
+        range_count = 0;
+      }
+    };
+
+    auto start = rowids[0];
+    auto end = rowids[0];
+    for (idx_t i = 1; i < rowids.size(); i++)
+    {
+      if (rowids[i] == end + 1)
+      {
+        end = rowids[i];
+        continue;
+      }
+      add_range(start, end);
+      start = end = rowids[i];
+    }
+    add_range(start, end);
+
+    if (range_count > 0)
+    {
+      ranges.SetCardinality(range_count);
+      ustate.write_buffer->Append(ranges);
+    }
+    rowids.clear();
+
+    AirportDeleteFlush(gstate, ustate);
+  }
+
+  unique_ptr<GlobalSinkState> AirportDelete::GetGlobalSinkState(ClientContext &context) const
+  {
+    auto &airport_table = table.Cast<AirportTableEntry>();
+
+    auto delete_global_state = make_uniq<AirportDeleteGlobalState>(context, airport_table, GetTypes(), return_chunk);
+
+    // With parallel exchanges each thread opens its own stream when it
+    // gets its first chunk.
+    if (!parallel_exchange)
+    {
+      OpenExchange(context, airport_table, *delete_global_state);
+      if (return_chunk)
+      {
+        AirportDeleteReadReturnedRows(context, *delete_global_state, *delete_global_state);
+      }
+    }
 
     return delete_global_state;
   }
 
   unique_ptr<LocalSinkState> AirportDelete::GetLocalSinkState(ExecutionContext &context) const
   {
-    return make_uniq<AirportDeleteLocalState>(context.client, table);
+    return make_uniq<AirportDeleteLocalState>();
   }
 
   //===--------------------------------------------------------------------===//
@@ -142,10 +264,45 @@ namespace duckdb
     auto &gstate = input.global_state.Cast<AirportDeleteGlobalState>();
     auto &ustate = input.local_state.Cast<AirportDeleteLocalState>();
 
-    // Since we need to return the data from the rows that we're deleting.
-    // we need do exchanges with the server chunk by chunk because if we batch everything
-    // up it could use a lot of memory and we wouldn't be able to return the data
-    // to the user.
+    if (parallel_exchange && !ustate.exchange)
+    {
+      ustate.exchange = make_uniq<AirportExchangeGlobalState>();
+      OpenExchange(context.client, gstate.table, *ustate.exchange);
+      if (return_chunk)
+      {
+        AirportDeleteReadReturnedRows(context.client, gstate, *ustate.exchange);
+      }
+    }
+    AirportExchangeGlobalState &exchange = ustate.exchange ? *ustate.exchange : gstate;
+
+    if (!ustate.write_buffer)
+    {
+      ustate.write_buffer = make_uniq<AirportExchangeWriteBuffer>(context.client, exchange.send_types);
+    }
+
+    if (rowid_ranges)
+    {
+      Vector rowid_vector(LogicalType::BIGINT, chunk.size());
+      VectorOperations::Cast(context.client, chunk.data[rowid_index], rowid_vector, chunk.size());
+
+      UnifiedVectorFormat rowid_format;
+      rowid_vector.ToUnifiedFormat(chunk.size(), rowid_format);
+      auto rowid_data = UnifiedVectorFormat::GetData<int64_t>(rowid_format);
+      for (idx_t i = 0; i < chunk.size(); i++)
+      {
+        auto idx = rowid_format.sel->get_index(i);
+        if (rowid_format.validity.RowIsValid(idx))
+        {
+          ustate.rowids.push_back(rowid_data[idx]);
+        }
+      }
+
+      if (ustate.rowids.size() >= MaxValue<idx_t>(AirportWriteBatchRows(context.client), STANDARD_VECTOR_SIZE))
+      {
+        AirportDeleteFlushRowIdRanges(context.client, gstate, ustate);
+      }
+      return SinkResultType::NEED_MORE_INPUT;
+    }
 
     // Somehow we're getting a chunk with 2 columns,
     // but we're only expecting one column.
@@ -153,59 +310,15 @@ namespace duckdb
     // So it turns out the chunk that it passed may have additional colums included,
     // especially if filtering is being applied, but we need to only send the row id column.
     auto small_chunk = DataChunk();
-    small_chunk.Initialize(context.client, gstate.send_types, chunk.size());
+    small_chunk.Initialize(context.client, exchange.send_types, chunk.size());
     small_chunk.data[0].Reference(chunk.data[rowid_index]);
     small_chunk.SetCardinality(chunk.size());
 
-    auto appender = make_uniq<ArrowAppender>(gstate.send_types, small_chunk.size(), context.client.GetClientProperties(),
-                                             ArrowTypeExtensionData::GetExtensionTypes(
-                                                 context.client, gstate.send_types));
-    appender->Append(small_chunk, 0, small_chunk.size(), small_chunk.size());
-    ArrowArray arr = appender->Finalize();
-
-    AIRPORT_ASSIGN_OR_RAISE_CONTAINER(
-        auto record_batch,
-        arrow::ImportRecordBatch(&arr, gstate.send_schema),
-        gstate.table.table_data,
-        "");
-
-    // Acquire a lock because we don't want other threads to be writing to the same streams
-    // at the same time.
-    lock_guard<mutex> delete_guard(gstate.delete_lock);
-
-    AIRPORT_ARROW_ASSERT_OK_CONTAINER(
-        gstate.writer->WriteRecordBatch(*record_batch),
-        gstate.table.table_data, "");
-
-    // Since we wrote a batch I'd like to read the data returned if we are returning chunks.
-    if (gstate.return_chunk)
+    // The deleted rows (if they are returned) are read on another thread,
+    // so the row ids can be sent in larger batches.
+    if (ustate.write_buffer->Append(small_chunk))
     {
-      ustate.delete_chunk.Reset();
-
-      {
-        auto &data = gstate.scan_table_function_input->bind_data->CastNoConst<AirportTakeFlightBindData>(); // FIXME
-        auto &state = gstate.scan_table_function_input->local_state->Cast<AirportArrowScanLocalState>();
-        // auto &global_state = gstate.scan_table_function_input->global_state->Cast<AirportArrowScanGlobalState>();
-
-        state.Reset();
-
-        state.chunk = state.stream()->GetNextChunk();
-
-        auto output_size =
-            MinValue<idx_t>(STANDARD_VECTOR_SIZE, NumericCast<idx_t>(state.chunk->arrow_array.length) - state.chunk_offset);
-        state.lines_read += output_size;
-        ustate.delete_chunk.SetCardinality(state.chunk->arrow_array.length);
-
-        // Assume that the data returned is the same size as the table.
-        //        D_ASSERT(data.arrow_table.GetColumns().size() == ustate.delete_chunk.ColumnCount());
-
-        ArrowTableFunction::ArrowToDuckDB(state,
-                                          data.arrow_table.GetColumns(),
-                                          ustate.delete_chunk,
-                                          state.lines_read - output_size, false);
-        ustate.delete_chunk.Verify();
-        gstate.return_collection.Append(ustate.delete_chunk);
-      }
+      AirportDeleteFlush(gstate, ustate);
     }
     return SinkResultType::NEED_MORE_INPUT;
   }
@@ -216,44 +329,63 @@ namespace duckdb
     MSGPACK_DEFINE_MAP(total_deleted)
   };
 
+  static idx_t AirportDeleteFinishExchange(AirportTableEntry &table, AirportExchangeGlobalState &exchange)
+  {
+    auto last_app_metadata = AirportExchangeFinish(table, exchange);
+    if (!last_app_metadata)
+    {
+      return 0;
+    }
+
+    AIRPORT_MSGPACK_UNPACK(AirportDeleteFinalMetadata, final_metadata,
+                           (*last_app_metadata),
+                           table.table_data->server_location(),
+                           "Failed to parse msgpack encoded object for final delete metadata.");
+    return final_metadata.total_deleted;
+  }
+
   //===--------------------------------------------------------------------===//
-  // Finalize
+  // Combine
   //===--------------------------------------------------------------------===//
-  SinkFinalizeType AirportDelete::Finalize(Pipeline &pipeline, Event &event, ClientContext &context,
-                                           OperatorSinkFinalizeInput &input) const
+  SinkCombineResultType AirportDelete::Combine(ExecutionContext &context, OperatorSinkCombineInput &input) const
   {
     auto &gstate = input.global_state.Cast<AirportDeleteGlobalState>();
+    auto &ustate = input.local_state.Cast<AirportDeleteLocalState>();
 
-    // printf("AirportDelete::Finalize started, indicating that writing is done\n");
+    if (ustate.write_buffer)
+    {
+      AirportDeleteFlushRowIdRanges(context.client, gstate, ustate);
+      AirportDeleteFlush(gstate, ustate);
+    }
 
-    AIRPORT_ARROW_ASSERT_OK_CONTAINER(
-        gstate.writer->DoneWriting(),
-        gstate.table.table_data, "");
+    if (!ustate.exchange)
+    {
+      return SinkCombineResultType::FINISHED;
+    }
 
-    // There should be a metadata message in the reader stream
-    // but the problem is the current interface just reads data
-    // chunks, and drops the metadata silently.
-    //
+    // Each stream reports the number of rows it deleted.
+    auto deleted = AirportDeleteFinishExchange(gstate.table, *ustate.exchange);
+    ustate.exchange.reset();
 
-    {
-      auto &bind_data = gstate.scan_table_function_input->bind_data->Cast<AirportTakeFlightBindData>(); // FIXME
-      auto &state = gstate.scan_table_function_input->local_state->Cast<AirportArrowScanLocalState>();
-      // auto &global_state = gstate.scan_table_function_input->global_state->Cast<AirportArrowScanGlobalState>();
+    lock_guard<mutex> delete_guard(gstate.delete_lock);
+    gstate.deleted_count += deleted;
 
-      state.Reset();
+    return SinkCombineResultType::FINISHED;
+  }
 
-      state.chunk = state.stream()->GetNextChunk();
+  //===--------------------------------------------------------------------===//
+  // Finalize
+  //===--------------------------------------------------------------------===//
+  SinkFinalizeType AirportDelete::Finalize(Pipeline &pipeline, Event &event, ClientContext &context,
+                                           OperatorSinkFinalizeInput &input) const
+  {
+    auto &gstate = input.global_state.Cast<AirportDeleteGlobalState>();
 
-      auto &last_app_metadata = bind_data.last_app_metadata;
+    // printf("AirportDelete::Finalize started, indicating that writing is done\n");
 
-      if (last_app_metadata)
-      {
-        AIRPORT_MSGPACK_UNPACK(AirportDeleteFinalMetadata, final_metadata,
-                               (*last_app_metadata),
-                               gstate.table.table_data->server_location(),
-                               "Failed to parse msgpack encoded object for final delete metadata.");
-        gstate.deleted_count = final_metadata.total_deleted;
-      }
+    if (!parallel_exchange)
+    {
+      gstate.deleted_count = AirportDeleteFinishExchange(gstate.table, gstate);
     }
 
     return SinkFinalizeType::READY;
@@ -315,6 +447,14 @@ namespace duckdb
   {
     InsertionOrderPreservingMap<string> result;
     result["Table Name"] = table.name;
+    if (parallel_exchange)
+    {
+      result["Parallel Exchange"] = "true";
+    }
+    if (rowid_ranges)
+    {
+      result["RowId Ranges"] = "true";
+    }
     return result;
   }
 
@@ -343,6 +483,8 @@ namespace duckdb
     }
 
     auto &del = planner.Make<AirportDelete>(op, op.table, bound_ref.index, op.return_chunk);
+    del.parallel_exchange = AirportExchangeSupportsParallelStreams(context, airport_table);
+    del.rowid_ranges = AirportTableSupportsRowIdRanges(context, airport_table);
     del.children.push_back(plan);
     return del;
   }
@@ -14,12 +14,20 @@
 #include "airport_request_headers.hpp"
 #include "airport_flight_exception.hpp"
 #include "airport_secrets.hpp"
+#include "airport_settings.hpp"
 #include "airport_flight_stream.hpp"
 #include "airport_take_flight.hpp"
 #include "storage/airport_exchange.hpp"
 #include "airport_schema_utils.hpp"
 #include "duckdb/common/arrow/schema_metadata.hpp"
+#include "duckdb/common/types/uuid.hpp"
+#include "msgpack.hpp"
+#include "duckdb/execution/operator/filter/physical_filter.hpp"
+#include "duckdb/execution/operator/projection/physical_projection.hpp"
+#include "duckdb/execution/operator/scan/physical_table_scan.hpp"
 
+#include <arrow/filesystem/api.h>
+#include <arrow/ipc/writer.h>
 #include <numeric>
 
 namespace duckdb
@@ -37,6 +45,36 @@ namespace duckdb
     return std::distance(vec.begin(), it);
   }
 
+  static void AirportDMLCallOptions(ClientContext &context,
+                                    const AirportTableEntry &airport_table,
+                                    arrow::flight::FlightCallOptions &call_options,
+                                    const string &operation,
+                                    const std::optional<string> &transaction_id,
+                                    const string &trace_uuid)
+  {
+    const auto &server_location = airport_table.table_data->server_location();
+
+    auto auth_token = AirportAuthTokenForLocation(context, server_location, "", "");
+
+    airport_add_standard_headers(call_options, server_location);
+    airport_add_authorization_header(call_options, auth_token);
+    airport_add_trace_id_header(call_options, trace_uuid);
+
+    // Indicate the operation, insert, update or delete.
+    call_options.headers.emplace_back("airport-operation", operation);
+
+    if (transaction_id.has_value() && !transaction_id.value().empty())
+    {
+      call_options.headers.emplace_back("airport-transaction-id", transaction_id.value());
+    }
+
+    airport_add_flight_path_header(call_options, airport_table.table_data->descriptor());
+
+    AirportUseMemoryPool(context, call_options);
+
+    AirportUseIpcCompression(context, call_options);
+  }
+
   void AirportExchangeGetGlobalSinkState(ClientContext &context,
                                          const TableCatalogEntry &table,
                                          const AirportTableEntry &airport_table,
@@ -45,7 +83,8 @@ namespace duckdb
                                          const bool return_chunk,
                                          const string exchange_operation,
                                          const vector<string> destination_chunk_column_names,
-                                         const std::optional<string> transaction_id)
+                                         const std::optional<string> transaction_id,
+                                         const std::shared_ptr<const arrow::KeyValueMetadata> &send_metadata)
   {
     AIRPORT_ASSIGN_OR_RAISE_CONTAINER(
         global_state->send_schema,
@@ -53,37 +92,30 @@ namespace duckdb
         airport_table.table_data,
         "");
 
+    // Anything the server needs to know about how to apply the rows
+    // beyond the operation (like the ON CONFLICT clause of an upsert).
+    if (send_metadata)
+    {
+      global_state->send_schema = global_state->send_schema->WithMetadata(send_metadata);
+    }
+
     const auto &server_location = airport_table.table_data->server_location();
     const auto &descriptor = airport_table.table_data->descriptor();
 
     // global_state->flight_descriptor = descriptor;
 
-    auto auth_token = AirportAuthTokenForLocation(context, server_location, "", "");
-
     D_ASSERT(airport_table.table_data != nullptr);
 
-    auto flight_client = AirportAPI::FlightClientForLocation(server_location);
+    auto flight_client = AirportAPI::FlightClientForLocation(*airport_table.GetCatalog().Cast<AirportCatalog>().attach_parameters());
 
     auto trace_uuid = airport_trace_id();
 
     arrow::flight::FlightCallOptions call_options;
-    airport_add_standard_headers(call_options, server_location);
-    airport_add_authorization_header(call_options, auth_token);
-    airport_add_trace_id_header(call_options, trace_uuid);
-
-    // Indicate that we are doing a delete.
-    call_options.headers.emplace_back("airport-operation", exchange_operation);
-
-    if (transaction_id.has_value() && !transaction_id.value().empty())
-    {
-      call_options.headers.emplace_back("airport-transaction-id", transaction_id.value());
-    }
+    AirportDMLCallOptions(context, airport_table, call_options, exchange_operation, transaction_id, trace_uuid);
 
     // Indicate if the caller is interested in data being returned.
     call_options.headers.emplace_back("return-chunks", return_chunk ? "1" : "0");
 
-    airport_add_flight_path_header(call_options, descriptor);
-
     AIRPORT_ASSIGN_OR_RAISE_CONTAINER(
         auto exchange_result,
         flight_client->DoExchange(call_options, descriptor),
@@ -91,7 +123,7 @@ namespace duckdb
 
     // Tell the server the schema that we will be using to write data.
     AIRPORT_ARROW_ASSERT_OK_CONTAINER(
-        exchange_result.writer->Begin(global_state->send_schema),
+        exchange_result.writer->Begin(global_state->send_schema, call_options.write_options),
         airport_table.table_data,
         "Begin schema");
 
@@ -242,4 +274,514 @@ namespace duckdb
         global_state->scan_local_state.get(),
         global_state->scan_global_state.get());
   }
-}
\ No newline at end of file
+
+  AirportExchangeWriteBuffer::AirportExchangeWriteBuffer(ClientContext &context, const vector<LogicalType> &types)
+      : context_(context), types_(types),
+        max_rows_(AirportWriteBatchRows(context)),
+        max_bytes_(AirportWriteBatchBytes(context))
+  {
+  }
+
+  bool AirportExchangeWriteBuffer::Append(DataChunk &chunk)
+  {
+    if (!appender_)
+    {
+      appender_ = make_uniq<ArrowAppender>(types_,
+                                           MaxValue<idx_t>(chunk.size(), MinValue<idx_t>(max_rows_, STANDARD_VECTOR_SIZE * 8)),
+                                           context_.GetClientProperties(),
+                                           ArrowTypeExtensionData::GetExtensionTypes(context_, types_));
+    }
+    appender_->Append(chunk, 0, chunk.size(), chunk.size());
+    row_count_ += chunk.size();
+    byte_count_ += chunk.GetAllocationSize();
+
+    return row_count_ >= max_rows_ || byte_count_ >= max_bytes_;
+  }
+
+  void AirportExchangeWriteBuffer::Flush(const AirportTableEntry &table, AirportExchangeGlobalState &exchange)
+  {
+    if (row_count_ == 0)
+    {
+      return;
+    }
+
+    ArrowArray arr = appender_->Finalize();
+    appender_.reset();
+    row_count_ = 0;
+    byte_count_ = 0;
+
+    AIRPORT_ASSIGN_OR_RAISE_CONTAINER(
+        auto record_batch,
+        arrow::ImportRecordBatch(&arr, exchange.send_schema),
+        table.table_data, "");
+
+    AIRPORT_ARROW_ASSERT_OK_CONTAINER(
+        exchange.batch_writer().WriteRecordBatch(*record_batch),
+        table.table_data, "");
+  }
+
+  void AirportPutGetGlobalSinkState(ClientContext &context,
+                                    const AirportTableEntry &airport_table,
+                                    AirportExchangeGlobalState *global_state,
+                                    const ArrowSchema &send_schema,
+                                    const std::optional<string> transaction_id)
+  {
+    AIRPORT_ASSIGN_OR_RAISE_CONTAINER(
+        global_state->send_schema,
+        arrow::ImportSchema((ArrowSchema *)&send_schema),
+        airport_table.table_data,
+        "");
+
+    const auto &server_location = airport_table.table_data->server_location();
+    const auto &descriptor = airport_table.table_data->descriptor();
+
+    auto flight_client = AirportAPI::FlightClientForLocation(*airport_table.GetCatalog().Cast<AirportCatalog>().attach_parameters());
+
+    arrow::flight::FlightCallOptions call_options;
+    AirportDMLCallOptions(context, airport_table, call_options, "insert", transaction_id, airport_trace_id());
+
+    // The writer is started with the schema by DoPut.
+    AIRPORT_ASSIGN_OR_RAISE_CONTAINER(
+        auto put_result,
+        flight_client->DoPut(call_options, descriptor, global_state->send_schema),
+        airport_table.table_data, "");
+
+    global_state->writer = std::move(put_result.writer);
+    global_state->put_reader = std::move(put_result.reader);
+  }
+
+  void AirportStagedIngestGetGlobalSinkState(ClientContext &context,
+                                             const AirportTableEntry &airport_table,
+                                             AirportExchangeGlobalState *global_state,
+                                             const ArrowSchema &send_schema,
+                                             const string &staging_uri)
+  {
+    AIRPORT_ASSIGN_OR_RAISE_CONTAINER(
+        global_state->send_schema,
+        arrow::ImportSchema((ArrowSchema *)&send_schema),
+        airport_table.table_data,
+        "");
+
+    std::string staging_path;
+    AIRPORT_ASSIGN_OR_RAISE_CONTAINER(
+        auto file_system,
+        arrow::fs::FileSystemFromUriOrPath(staging_uri, &staging_path),
+        airport_table.table_data,
+        "airport_ingest_staging_uri");
+
+    AIRPORT_ARROW_ASSERT_OK_CONTAINER(
+        file_system->CreateDir(staging_path, true),
+        airport_table.table_data,
+        "creating staging directory");
+
+    // Every stream of every insert has its own file.
+    const auto file_name = UUID::ToString(UUID::GenerateRandomUUID()) + ".arrow";
+    auto base_uri = staging_uri;
+    while (!base_uri.empty() && base_uri.back() == '/')
+    {
+      base_uri.pop_back();
+    }
+    // Tracked before it is opened, so a partly written file is removed too.
+    global_state->staged_file = make_uniq<AirportStagedFile>(file_system, staging_path + "/" + file_name, base_uri + "/" + file_name);
+
+    AIRPORT_ASSIGN_OR_RAISE_CONTAINER(
+        global_state->staged_output,
+        file_system->OpenOutputStream(staging_path + "/" + file_name),
+        airport_table.table_data,
+        "opening staged file");
+
+    // The files use the same compression as batches sent over Flight.
+    arrow::flight::FlightCallOptions call_options;
+    AirportUseIpcCompression(context, call_options);
+
+    AIRPORT_ASSIGN_OR_RAISE_CONTAINER(
+        global_state->staged_writer,
+        arrow::ipc::MakeFileWriter(global_state->staged_output, global_state->send_schema, call_options.write_options),
+        airport_table.table_data,
+        "writing staged file");
+  }
+
+  AirportStagedFile::~AirportStagedFile()
+  {
+    if (!released_)
+    {
+      // Nothing can be done if it can't be removed, and it may not even
+      // have been created.
+      (void)file_system_->DeleteFile(path_);
+    }
+  }
+
+  struct AirportIngestStagedFilesParameters
+  {
+    // The serialized flight descriptor of the table.
+    std::string descriptor;
+    // Always "ipc-file" for now, the same name used for data URIs of endpoints.
+    std::string format;
+    std::vector<std::string> uris;
+
+    MSGPACK_DEFINE_MAP(descriptor, format, uris)
+  };
+
+  std::shared_ptr<arrow::Buffer> AirportIngestStagedFiles(ClientContext &context,
+                                                          const AirportTableEntry &airport_table,
+                                                          const vector<string> &uris,
+                                                          const std::optional<string> transaction_id)
+  {
+    const auto &server_location = airport_table.table_data->server_location();
+
+    AirportIngestStagedFilesParameters params;
+    AIRPORT_ASSIGN_OR_RAISE_CONTAINER(
+        params.descriptor,
+        airport_table.table_data->descriptor().SerializeToString(),
+        airport_table.table_data,
+        "");
+    params.format = "ipc-file";
+    params.uris.assign(uris.begin(), uris.end());
+
+    arrow::flight::FlightCallOptions call_options;
+    AirportDMLCallOptions(context, airport_table, call_options, "insert", transaction_id, airport_trace_id());
+    call_options.headers.emplace_back("airport-action-name", "ingest_staged_files");
+
+    AIRPORT_MSGPACK_ACTION_SINGLE_PARAMETER(action, "ingest_staged_files", params);
+
+    auto flight_client = AirportAPI::FlightClientForLocation(*airport_table.GetCatalog().Cast<AirportCatalog>().attach_parameters());
+
+    AIRPORT_ASSIGN_OR_RAISE_LOCATION(auto action_results,
+                                     flight_client->DoAction(call_options, action),
+                                     server_location,
+                                     "calling ingest_staged_files action");
+
+    AIRPORT_ASSIGN_OR_RAISE_LOCATION(auto result_buffer,
+                                     action_results->Next(),
+                                     server_location,
+                                     "reading ingest_staged_files action result");
+
+    AIRPORT_ARROW_ASSERT_OK_LOCATION(action_results->Drain(), server_location, "");
+
+    if (!result_buffer)
+    {
+      return nullptr;
+    }
+    return result_buffer->body;
+  }
+
+  PhysicalTableScan &AirportParameterizedScan(PhysicalOperator &child, const string &statement, bool &has_filter)
+  {
+    switch (child.type)
+    {
+    case PhysicalOperatorType::FILTER:
+      has_filter = true;
+      return AirportParameterizedScan(child.children[0], statement, has_filter);
+    case PhysicalOperatorType::PROJECTION:
+      return AirportParameterizedScan(child.children[0], statement, has_filter);
+    case PhysicalOperatorType::TABLE_SCAN:
+    {
+      auto &table_scan = child.Cast<PhysicalTableScan>();
+      if (table_scan.function.name != "airport_take_flight" || !table_scan.bind_data)
+      {
+        break;
+      }
+      return table_scan;
+    }
+    default:
+      break;
+    }
+    throw NotImplementedException("Unsupported operator type %s in %s statement - only simple expressions "
+                                  "(e.g. %s FROM tbl WHERE x=y) are supported for Airport tables without row ids",
+                                  PhysicalOperatorToString(child.type), statement, statement);
+  }
+
+  string AirportParameterizedFilters(PhysicalOperator &child, const string &statement)
+  {
+    bool has_filter = false;
+    auto &table_scan = AirportParameterizedScan(child, statement, has_filter);
+    auto &bind_data = table_scan.bind_data->Cast<AirportTakeFlightBindData>();
+
+    // The filters were serialized when they were pushed down to the scan,
+    // if that didn't happen (the filter pushdown optimizer can be turned
+    // off) the server would be asked to change every row.
+    if (has_filter && bind_data.json_filters.empty())
+    {
+      throw NotImplementedException("The filters of the %s statement could not be pushed down to the Airport server", statement);
+    }
+    return bind_data.json_filters;
+  }
+
+  struct AirportParameterizedDMLParameters
+  {
+    // The serialized flight descriptor of the table.
+    std::string descriptor;
+    // The filters in the same format as the filters sent with a scan, an
+    // empty string if every row is affected.
+    std::string json_filters;
+    // The SET expressions of an update, empty for a delete.
+    std::string json_expressions;
+
+    MSGPACK_DEFINE_MAP(descriptor, json_filters, json_expressions)
+  };
+
+  std::shared_ptr<arrow::Buffer> AirportParameterizedDML(ClientContext &context,
+                                                         const AirportTableEntry &airport_table,
+                                                         const string &operation,
+                                                         const string &json_filters,
+                                                         const string &json_expressions,
+                                                         const std::optional<string> transaction_id)
+  {
+    const auto &server_location = airport_table.table_data->server_location();
+
+    AirportParameterizedDMLParameters params;
+    AIRPORT_ASSIGN_OR_RAISE_CONTAINER(
+        params.descriptor,
+        airport_table.table_data->descriptor().SerializeToString(),
+        airport_table.table_data,
+        "");
+    params.json_filters = json_filters;
+    params.json_expressions = json_expressions;
+
+    const auto action_name = "parameterized_" + operation;
+
+    arrow::flight::FlightCallOptions call_options;
+    AirportDMLCallOptions(context, airport_table, call_options, operation, transaction_id, airport_trace_id());
+    call_options.headers.emplace_back("airport-action-name", action_name);
+
+    AIRPORT_MSGPACK_ACTION_SINGLE_PARAMETER(action, action_name, params);
+
+    auto flight_client = AirportAPI::FlightClientForLocation(*airport_table.GetCatalog().Cast<AirportCatalog>().attach_parameters());
+
+    AIRPORT_ASSIGN_OR_RAISE_LOCATION(auto action_results,
+                                     flight_client->DoAction(call_options, action),
+                                     server_location,
+                                     "calling " + action_name + " action");
+
+    AIRPORT_ASSIGN_OR_RAISE_LOCATION(auto result_buffer,
+                                     action_results->Next(),
+                                     server_location,
+                                     "reading " + action_name + " action result");
+
+    AIRPORT_ARROW_ASSERT_OK_LOCATION(action_results->Drain(), server_location, "");
+
+    if (!result_buffer)
+    {
+      return nullptr;
+    }
+    return result_buffer->body;
+  }
+
+  static bool AirportTableMetadataFlag(const AirportTableEntry &table, const string &key)
+  {
+    if (!table.table_data)
+    {
+      return false;
+    }
+
+    auto &schema = table.table_data->schema();
+    if (!schema || !schema->metadata())
+    {
+      return false;
+    }
+
+    auto flag = schema->metadata()->Get(key);
+    if (!flag.ok())
+    {
+      return false;
+    }
+
+    auto value = StringUtil::Lower(*flag);
+    return value == "true" || value == "1";
+  }
+
+  bool AirportExchangeSupportsParallelStreams(ClientContext &context, const AirportTableEntry &table)
+  {
+    return AirportGetBooleanSetting(context, "airport_parallel_exchange", true) &&
+           AirportTableMetadataFlag(table, "parallel_exchange");
+  }
+
+  bool AirportTableSupportsStagedIngest(ClientContext &context, const AirportTableEntry &table, string &staging_uri)
+  {
+    Value setting;
+    if (!context.TryGetCurrentSetting("airport_ingest_staging_uri", setting) || setting.IsNull())
+    {
+      return false;
+    }
+    staging_uri = setting.ToString();
+    return !staging_uri.empty() && AirportTableMetadataFlag(table, "staged_ingest");
+  }
+
+  bool AirportTableSupportsRowIdRanges(ClientContext &context, const AirportTableEntry &table)
+  {
+    switch (table.GetRowIdType().id())
+    {
+    case LogicalTypeId::TINYINT:
+    case LogicalTypeId::SMALLINT:
+    case LogicalTypeId::INTEGER:
+    case LogicalTypeId::BIGINT:
+    case LogicalTypeId::UTINYINT:
+    case LogicalTypeId::USMALLINT:
+    case LogicalTypeId::UINTEGER:
+      break;
+    default:
+      return false;
+    }
+    return AirportGetBooleanSetting(context, "airport_delete_rowid_ranges", true) &&
+           AirportTableMetadataFlag(table, "rowid_ranges");
+  }
+
+  bool AirportTableSupportsPutIngest(ClientContext &context, const AirportTableEntry &table)
+  {
+    return AirportGetBooleanSetting(context, "airport_put_ingest", true) &&
+           AirportTableMetadataFlag(table, "put_ingest");
+  }
+
+  AirportExchangeReturnReader::AirportExchangeReturnReader(ClientContext &context,
+                                                           AirportExchangeGlobalState &exchange,
+                                                           const vector<LogicalType> &types,
+                                                           append_t append)
+      : context_(context), exchange_(exchange), types_(types), append_(std::move(append))
+  {
+    thread_ = std::thread([this]()
+                          { Run(); });
+  }
+
+  AirportExchangeReturnReader::~AirportExchangeReturnReader()
+  {
+    if (thread_.joinable())
+    {
+      // The statement failed before the stream was finished. The server
+      // may never end the stream (or may be stuck waiting to send), so
+      // cancel the call rather than wait for it, which wakes the thread
+      // if it is blocked on the network.
+      if (!finished_)
+      {
+        auto &state = exchange_.scan_table_function_input->local_state->Cast<AirportArrowScanLocalState>();
+        auto reader = std::get_if<std::shared_ptr<arrow::flight::FlightStreamReader>>(&state.reader());
+        if (reader && *reader)
+        {
+          (*reader)->Cancel();
+        }
+      }
+      (void)exchange_.writer->DoneWriting();
+      thread_.join();
+    }
+  }
+
+  void AirportExchangeReturnReader::Join()
+  {
+    if (thread_.joinable())
+    {
+      thread_.join();
+    }
+    if (error_.HasError())
+    {
+      error_.Throw();
+    }
+  }
+
+  void AirportExchangeReturnReader::Run()
+  {
+    try
+    {
+      auto &data = exchange_.scan_table_function_input->bind_data->CastNoConst<AirportTakeFlightBindData>();
+      auto &state = exchange_.scan_table_function_input->local_state->Cast<AirportArrowScanLocalState>();
+
+      DataChunk chunk;
+      chunk.Initialize(Allocator::Get(context_), types_);
+
+      while (true)
+      {
+        state.Reset();
+        state.chunk = state.stream()->GetNextChunk();
+
+        // A message without a batch ends the stream, it carries the final
+        // metadata.
+        if (!state.chunk->arrow_array.release)
+        {
+          final_metadata_ = data.last_app_metadata;
+          finished_ = true;
+          return;
+        }
+
+        const auto array_length = NumericCast<idx_t>(state.chunk->arrow_array.length);
+        while (state.chunk_offset < array_length)
+        {
+          auto output_size = MinValue<idx_t>(STANDARD_VECTOR_SIZE, array_length - state.chunk_offset);
+          state.lines_read += output_size;
+
+          chunk.Reset();
+          chunk.SetCardinality(output_size);
+          ArrowTableFunction::ArrowToDuckDB(state,
+                                            data.arrow_table.GetColumns(),
+                                            chunk,
+                                            state.lines_read - output_size,
+                                            false);
+          chunk.Verify();
+          append_(chunk);
+
+          state.chunk_offset += output_size;
+        }
+      }
+    }
+    catch (std::exception &ex)
+    {
+      error_ = ErrorData(ex);
+    }
+    finished_ = true;
+  }
+
+  std::shared_ptr<arrow::Buffer> AirportExchangeFinish(const AirportTableEntry &table,
+                                                       AirportExchangeGlobalState &exchange)
+  {
+    if (exchange.staged_writer)
+    {
+      AIRPORT_ARROW_ASSERT_OK_CONTAINER(
+          exchange.staged_writer->Close(),
+          table.table_data, "closing staged file");
+      AIRPORT_ARROW_ASSERT_OK_CONTAINER(
+          exchange.staged_output->Close(),
+          table.table_data, "closing staged file");
+      return nullptr;
+    }
+
+    AIRPORT_ARROW_ASSERT_OK_CONTAINER(
+        exchange.writer->DoneWriting(),
+        table.table_data, "");
+
+    if (exchange.return_reader)
+    {
+      exchange.return_reader->Join();
+      return exchange.return_reader->final_metadata();
+    }
+
+    if (exchange.put_reader)
+    {
+      // The final metadata is in the last PutResult the server sends.
+      std::shared_ptr<arrow::Buffer> final_metadata;
+      while (true)
+      {
+        std::shared_ptr<arrow::Buffer> metadata;
+        AIRPORT_ARROW_ASSERT_OK_CONTAINER(
+            exchange.put_reader->ReadMetadata(&metadata),
+            table.table_data, "");
+        if (!metadata)
+        {
+          break;
+        }
+        final_metadata = std::move(metadata);
+      }
+
+      AIRPORT_ARROW_ASSERT_OK_CONTAINER(
+          exchange.writer->Close(),
+          table.table_data, "");
+
+      return final_metadata;
+    }
+
+    // The final metadata message is read along with the last chunk.
+    auto &bind_data = exchange.scan_table_function_input->bind_data->Cast<AirportTakeFlightBindData>();
+    auto &state = exchange.scan_table_function_input->local_state->Cast<AirportArrowScanLocalState>();
+
+    state.Reset();
+    state.chunk = state.stream()->GetNextChunk();
+
+    return bind_data.last_app_metadata;
+  }
+}
@@ -26,6 +26,10 @@
 #include "airport_constraints.hpp"
 #include "duckdb/storage/table/append_state.hpp"
 #include "msgpack.hpp"
+#include "airport_json_common.hpp"
+#include "airport_json_serializer.hpp"
+#include "airport_settings.hpp"
+#include <arrow/util/key_value_metadata.h>
 
 namespace duckdb
 {
@@ -73,6 +77,14 @@ namespace duckdb
     idx_t insert_count;
     mutex insert_lock;
 
+    // The files the rows were staged to, given to the server in Finalize.
+    // Until then they are removed if the insert fails.
+    vector<unique_ptr<AirportStagedFile>> staged_files;
+
+    // The returned rows are added by the reader threads of the exchanges,
+    // this doesn't use insert_lock since a writer can hold that while it
+    // waits for the server to accept a batch.
+    mutex return_lock;
     ColumnDataCollection return_collection;
 
     const bool return_chunk;
@@ -101,6 +113,13 @@ namespace duckdb
     unique_ptr<ConstraintState> constraint_state_;
 
     DataChunk returning_data_chunk;
+
+    // The stream of this thread, only used when the table supports
+    // parallel exchanges.
+    unique_ptr<AirportExchangeGlobalState> exchange;
+
+    // The rows waiting to be sent.
+    unique_ptr<AirportExchangeWriteBuffer> write_buffer;
   };
 
   ConstraintState &AirportInsertLocalState::GetConstraintState(TableCatalogEntry &table, TableCatalogEntry &tableref)
@@ -144,31 +163,14 @@ namespace duckdb
     return make_pair(column_names, column_types);
   }
 
-  unique_ptr<GlobalSinkState> AirportInsert::GetGlobalSinkState(ClientContext &context) const
+  void AirportInsert::OpenExchange(ClientContext &context, AirportTableEntry &table, AirportExchangeGlobalState &exchange) const
   {
-    optional_ptr<AirportTableEntry> table;
-    //    AirportTableEntry *insert_table;
-    if (info)
-    {
-      // Create table as
-      D_ASSERT(!insert_table);
-      auto &schema_ref = *schema.get_mutable();
-      table = &schema_ref.CreateTable(schema_ref.GetCatalogTransaction(context), *info)->Cast<AirportTableEntry>();
-    }
-    else
-    {
-      D_ASSERT(insert_table);
-      table = &insert_table.get_mutable()->Cast<AirportTableEntry>();
-    }
-
-    auto insert_global_state = make_uniq<AirportInsertGlobalState>(context, *table, GetTypes(), return_chunk);
-
-    const auto &transaction = AirportTransaction::Get(context, table->GetCatalog());
+    const auto &transaction = AirportTransaction::Get(context, table.GetCatalog());
     // auto &connection = transaction.GetConnection();
-    auto [send_names, send_types] = AirportGetInsertColumns(*this, *table);
+    auto [send_names, send_types] = AirportGetInsertColumns(*this, table);
 
-    insert_global_state->send_types = send_types;
-    insert_global_state->send_names = send_names;
+    exchange.send_types = send_types;
+    exchange.send_names = send_names;
 
     // FIXME: so if the user doesn't specify the column list
     // it means that the send_names/send_types is empty.
@@ -180,28 +182,135 @@ namespace duckdb
     ArrowSchema send_schema;
     auto client_properties = context.GetClientProperties();
     ArrowConverter::ToArrowSchema(&send_schema,
-                                  insert_global_state->send_types,
+                                  exchange.send_types,
                                   send_names,
                                   client_properties);
 
-    D_ASSERT(table != nullptr);
+    // An upsert always uses DoExchange, the ON CONFLICT clause goes along
+    // in the metadata of the schema.
+    if (action_type != OnConflictAction::THROW)
+    {
+      vector<string> returning_column_names;
+      returning_column_names.reserve(table.GetColumns().LogicalColumnCount());
+      for (auto &cd : table.GetColumns().Logical())
+      {
+        returning_column_names.push_back(cd.GetName());
+      }
+
+      AirportExchangeGetGlobalSinkState(context,
+                                        table,
+                                        table,
+                                        &exchange,
+                                        send_schema,
+                                        return_chunk,
+                                        "upsert",
+                                        returning_column_names,
+                                        transaction.identifier(),
+                                        arrow::key_value_metadata({"airport_on_conflict"}, {on_conflict}));
+      return;
+    }
+
+    // The fastest way for a server to get the rows may be to read them
+    // from files it can reach itself.
+    string staging_uri;
+    if (!return_chunk && AirportTableSupportsStagedIngest(context, table, staging_uri))
+    {
+      AirportStagedIngestGetGlobalSinkState(context, table, &exchange, send_schema, staging_uri);
+      return;
+    }
+
+    // Servers can take plain inserts with DoPut and their own bulk loading,
+    // rather than a DoExchange that has to keep a reader open.
+    if (!return_chunk && AirportTableSupportsPutIngest(context, table))
+    {
+      AirportPutGetGlobalSinkState(context, table, &exchange, send_schema, transaction.identifier());
+      return;
+    }
 
     vector<string> returning_column_names;
-    returning_column_names.reserve(table->GetColumns().LogicalColumnCount());
-    for (auto &cd : table->GetColumns().Logical())
+    returning_column_names.reserve(table.GetColumns().LogicalColumnCount());
+    for (auto &cd : table.GetColumns().Logical())
     {
       returning_column_names.push_back(cd.GetName());
     }
 
     AirportExchangeGetGlobalSinkState(context,
-                                      *table.get(),
-                                      *table,
-                                      insert_global_state.get(),
+                                      table,
+                                      table,
+                                      &exchange,
                                       send_schema,
                                       return_chunk,
                                       "insert",
                                       returning_column_names,
                                       transaction.identifier());
+  }
+
+  // The inserted rows are read from the exchange while rows are still
+  // being written to it.
+  static void AirportInsertReadReturnedRows(ClientContext &context,
+                                            AirportInsertGlobalState &gstate,
+                                            AirportExchangeGlobalState &exchange)
+  {
+    exchange.return_reader = make_uniq<AirportExchangeReturnReader>(
+        context, exchange, gstate.table.GetTypes(),
+        [&gstate](DataChunk &returned)
+        {
+          lock_guard<mutex> return_guard(gstate.return_lock);
+          gstate.return_collection.Append(returned);
+        });
+  }
+
+  unique_ptr<GlobalSinkState> AirportInsert::GetGlobalSinkState(ClientContext &context) const
+  {
+    optional_ptr<AirportTableEntry> table;
+    //    AirportTableEntry *insert_table;
+    if (info)
+    {
+      // Create table as
+      D_ASSERT(!insert_table);
+      auto &schema_ref = *schema.get_mutable();
+      table = &schema_ref.CreateTable(schema_ref.GetCatalogTransaction(context), *info)->Cast<AirportTableEntry>();
+    }
+    else
+    {
+      D_ASSERT(insert_table);
+      table = &insert_table.get_mutable()->Cast<AirportTableEntry>();
+    }
+
+    D_ASSERT(table != nullptr);
+
+    auto insert_global_state = make_uniq<AirportInsertGlobalState>(context, *table, GetTypes(), return_chunk);
+
+    if (write_behind)
+    {
+      // The rows go to the transaction, the names are still needed to
+      // check the constraints.
+      insert_global_state->send_names = AirportGetInsertColumns(*this, *table).first;
+      return insert_global_state;
+    }
+
+    if (insert_table)
+    {
+      // Rows held back by earlier statements have to reach the server
+      // before these.
+      auto &transaction = AirportTransaction::Get(context, table->GetCatalog());
+      transaction.FlushBufferedInserts(context, table);
+    }
+
+    if (parallel_exchange)
+    {
+      // Each thread opens its own stream when it gets its first chunk,
+      // the names are still needed to check the constraints.
+      insert_global_state->send_names = AirportGetInsertColumns(*this, *table).first;
+    }
+    else
+    {
+      OpenExchange(context, *table, *insert_global_state);
+      if (return_chunk)
+      {
+        AirportInsertReadReturnedRows(context, *insert_global_state, *insert_global_state);
+      }
+    }
 
     return insert_global_state;
   }
@@ -220,12 +329,10 @@ namespace duckdb
                                           AirportInsertLocalState &lstate,
                                           DataChunk &chunk) const
   {
-    if (action_type == OnConflictAction::THROW)
-    {
-      auto &constraint_state = lstate.GetConstraintState(table, table);
-      AirportVerifyAppendConstraints(constraint_state, context.client, chunk, nullptr, gstate.send_names);
-      return 0;
-    }
+    // Conflicts are found and handled by the server, but the rows still
+    // have to satisfy the other constraints.
+    auto &constraint_state = lstate.GetConstraintState(table, table);
+    AirportVerifyAppendConstraints(constraint_state, context.client, chunk, nullptr, gstate.send_names);
     return 0;
   }
 
@@ -271,6 +378,17 @@ namespace duckdb
     }
   }
 
+  static void AirportInsertFlush(AirportInsertGlobalState &gstate, AirportInsertLocalState &ustate)
+  {
+    if (ustate.exchange)
+    {
+      ustate.write_buffer->Flush(gstate.table, *ustate.exchange);
+      return;
+    }
+    lock_guard<mutex> insert_guard(gstate.insert_lock);
+    ustate.write_buffer->Flush(gstate.table, gstate);
+  }
+
   //===--------------------------------------------------------------------===//
   // Sink
   //===--------------------------------------------------------------------===//
@@ -286,52 +404,36 @@ namespace duckdb
     // So there is some confusion about which columns are at a particular index.
     OnConflictHandling(gstate.table, context, gstate, ustate, ustate.returning_data_chunk);
 
-    auto appender = make_uniq<ArrowAppender>(gstate.send_types, ustate.returning_data_chunk.size(), context.client.GetClientProperties(),
-                                             ArrowTypeExtensionData::GetExtensionTypes(
-                                                 context.client, gstate.send_types));
-    appender->Append(ustate.returning_data_chunk, 0, ustate.returning_data_chunk.size(), ustate.returning_data_chunk.size());
-    ArrowArray arr = appender->Finalize();
-
-    AIRPORT_ASSIGN_OR_RAISE_CONTAINER(
-        auto record_batch,
-        arrow::ImportRecordBatch(&arr, gstate.send_schema),
-        gstate.table.table_data, "");
-
-    // Acquire a lock because we don't want other threads to be writing to the same streams
-    // at the same time.
-    lock_guard<mutex> delete_guard(gstate.insert_lock);
-
-    AIRPORT_ARROW_ASSERT_OK_CONTAINER(
-        gstate.writer->WriteRecordBatch(*record_batch),
-        gstate.table.table_data, "");
-
-    // Since we wrote a batch I'd like to read the data returned if we are returning chunks.
-    if (gstate.return_chunk)
+    if (write_behind)
     {
-      ustate.returning_data_chunk.Reset();
+      auto &transaction = AirportTransaction::Get(context.client, gstate.table.GetCatalog());
+      auto buffered = transaction.BufferInsert(context.client, gstate.table, ustate.returning_data_chunk);
+      lock_guard<mutex> insert_guard(gstate.insert_lock);
+      gstate.insert_count += buffered;
+      return SinkResultType::NEED_MORE_INPUT;
+    }
 
+    if (parallel_exchange && !ustate.exchange)
+    {
+      ustate.exchange = make_uniq<AirportExchangeGlobalState>();
+      OpenExchange(context.client, gstate.table, *ustate.exchange);
+      if (return_chunk)
       {
-        auto &data = gstate.scan_table_function_input->bind_data->CastNoConst<AirportTakeFlightBindData>(); // FIXME
-        auto &state = gstate.scan_table_function_input->local_state->Cast<AirportArrowScanLocalState>();
-        // auto &global_state = gstate.scan_table_function_input->global_state->Cast<AirportArrowScanGlobalState>();
-
-        state.Reset();
-        state.chunk = state.stream()->GetNextChunk();
-
-        auto output_size =
-            MinValue<idx_t>(STANDARD_VECTOR_SIZE, NumericCast<idx_t>(state.chunk->arrow_array.length) - state.chunk_offset);
-        state.lines_read += output_size;
-        ustate.returning_data_chunk.SetCardinality(state.chunk->arrow_array.length);
-
-        ArrowTableFunction::ArrowToDuckDB(state,
-                                          data.arrow_table.GetColumns(),
-                                          ustate.returning_data_chunk,
-                                          state.lines_read - output_size,
-                                          false);
-        ustate.returning_data_chunk.Verify();
-        gstate.return_collection.Append(ustate.returning_data_chunk);
+        AirportInsertReadReturnedRows(context.client, gstate, *ustate.exchange);
       }
     }
+    AirportExchangeGlobalState &exchange = ustate.exchange ? *ustate.exchange : gstate;
+
+    // The inserted rows (if they are returned) are read on another thread,
+    // so the rows can be sent in larger batches.
+    if (!ustate.write_buffer)
+    {
+      ustate.write_buffer = make_uniq<AirportExchangeWriteBuffer>(context.client, exchange.send_types);
+    }
+    if (ustate.write_buffer->Append(ustate.returning_data_chunk))
+    {
+      AirportInsertFlush(gstate, ustate);
+    }
 
     return SinkResultType::NEED_MORE_INPUT;
   }
@@ -342,38 +444,98 @@ namespace duckdb
     MSGPACK_DEFINE_MAP(total_inserted)
   };
 
+  static idx_t AirportInsertFinishExchange(AirportTableEntry &table, AirportExchangeGlobalState &exchange)
+  {
+    auto last_app_metadata = AirportExchangeFinish(table, exchange);
+    if (!last_app_metadata)
+    {
+      return 0;
+    }
+
+    AIRPORT_MSGPACK_UNPACK(
+        AirportInsertFinalMetadata, final_metadata,
+        (*last_app_metadata),
+        table.table_data->server_location(),
+        "Failed to parse msgpack encoded object for final insert metadata.");
+    return final_metadata.total_inserted;
+  }
+
   //===--------------------------------------------------------------------===//
-  // Finalize
+  // Combine
   //===--------------------------------------------------------------------===//
-  SinkFinalizeType AirportInsert::Finalize(Pipeline &pipeline, Event &event, ClientContext &context,
-                                           OperatorSinkFinalizeInput &input) const
+  SinkCombineResultType AirportInsert::Combine(ExecutionContext &context, OperatorSinkCombineInput &input) const
   {
     auto &gstate = input.global_state.Cast<AirportInsertGlobalState>();
+    auto &ustate = input.local_state.Cast<AirportInsertLocalState>();
 
-    // printf("AirportDelete::Finalize started, indicating that writing is done\n");
+    if (ustate.write_buffer)
+    {
+      AirportInsertFlush(gstate, ustate);
+    }
 
-    AIRPORT_ARROW_ASSERT_OK_CONTAINER(
-        gstate.writer->DoneWriting(),
-        gstate.table.table_data, "");
+    if (!ustate.exchange)
+    {
+      return SinkCombineResultType::FINISHED;
+    }
+
+    // Each stream reports the number of rows it inserted.
+    auto inserted = AirportInsertFinishExchange(gstate.table, *ustate.exchange);
 
+    lock_guard<mutex> insert_guard(gstate.insert_lock);
+    gstate.insert_count += inserted;
+    if (ustate.exchange->staged_file)
     {
-      auto &bind_data = gstate.scan_table_function_input->bind_data->Cast<AirportTakeFlightBindData>(); // FIXME
-      auto &state = gstate.scan_table_function_input->local_state->Cast<AirportArrowScanLocalState>();
-      // auto &global_state = gstate.scan_table_function_input->global_state->Cast<AirportArrowScanGlobalState>();
+      gstate.staged_files.push_back(std::move(ustate.exchange->staged_file));
+    }
+    ustate.exchange.reset();
 
-      state.Reset();
+    return SinkCombineResultType::FINISHED;
+  }
 
-      state.chunk = state.stream()->GetNextChunk();
-      auto &last_app_metadata = bind_data.last_app_metadata;
+  //===--------------------------------------------------------------------===//
+  // Finalize
+  //===--------------------------------------------------------------------===//
+  SinkFinalizeType AirportInsert::Finalize(Pipeline &pipeline, Event &event, ClientContext &context,
+                                           OperatorSinkFinalizeInput &input) const
+  {
+    auto &gstate = input.global_state.Cast<AirportInsertGlobalState>();
+
+    if (write_behind)
+    {
+      return SinkFinalizeType::READY;
+    }
+
+    if (!parallel_exchange)
+    {
+      gstate.insert_count = AirportInsertFinishExchange(gstate.table, gstate);
+      if (gstate.staged_file)
+      {
+        gstate.staged_files.push_back(std::move(gstate.staged_file));
+      }
+    }
 
-      if (last_app_metadata)
+    if (!gstate.staged_files.empty())
+    {
+      vector<string> staged_uris;
+      for (auto &staged_file : gstate.staged_files)
+      {
+        staged_uris.push_back(staged_file->uri());
+      }
+      const auto &transaction = AirportTransaction::Get(context, gstate.table.GetCatalog());
+      auto result = AirportIngestStagedFiles(context, gstate.table, staged_uris, transaction.identifier());
+      // The server took the files, they are its to remove now.
+      for (auto &staged_file : gstate.staged_files)
+      {
+        staged_file->Release();
+      }
+      if (result)
       {
         AIRPORT_MSGPACK_UNPACK(
             AirportInsertFinalMetadata, final_metadata,
-            (*last_app_metadata),
+            (*result),
             gstate.table.table_data->server_location(),
-            "Failed to parse msgpack encoded object for final insert metadata.");
-        gstate.insert_count = final_metadata.total_inserted;
+            "Failed to parse msgpack encoded object for ingest_staged_files result.");
+        gstate.insert_count += final_metadata.total_inserted;
       }
     }
 
@@ -436,18 +598,171 @@ namespace duckdb
   {
     InsertionOrderPreservingMap<string> result;
     result["Table Name"] = !info ? insert_table->name : info->Base().table;
+    if (parallel_exchange)
+    {
+      result["Parallel Exchange"] = "true";
+    }
+    if (action_type != OnConflictAction::THROW)
+    {
+      result["On Conflict"] = EnumUtil::ToString(action_type);
+    }
+    if (write_behind)
+    {
+      result["Write Behind"] = "true";
+    }
     return result;
   }
 
+  idx_t AirportInsertBufferedRows(ClientContext &context,
+                                  AirportTableEntry &table,
+                                  ColumnDataCollection &rows,
+                                  const std::optional<string> &transaction_id)
+  {
+    if (rows.Count() == 0)
+    {
+      return 0;
+    }
+
+    vector<string> send_names;
+    for (auto &cd : table.GetColumns().Logical())
+    {
+      send_names.push_back(cd.GetName());
+    }
+
+    AirportExchangeGlobalState exchange;
+    exchange.send_types = rows.Types();
+    exchange.send_names = send_names;
+
+    ArrowSchema send_schema;
+    auto client_properties = context.GetClientProperties();
+    ArrowConverter::ToArrowSchema(&send_schema,
+                                  exchange.send_types,
+                                  send_names,
+                                  client_properties);
+
+    AirportExchangeGetGlobalSinkState(context,
+                                      table,
+                                      table,
+                                      &exchange,
+                                      send_schema,
+                                      false,
+                                      "insert",
+                                      send_names,
+                                      transaction_id);
+
+    AirportExchangeWriteBuffer write_buffer(context, exchange.send_types);
+    for (auto &chunk : rows.Chunks())
+    {
+      if (write_buffer.Append(chunk))
+      {
+        write_buffer.Flush(table, exchange);
+      }
+    }
+    write_buffer.Flush(table, exchange);
+
+    return AirportInsertFinishExchange(table, exchange);
+  }
+
+  // Serialize the ON CONFLICT clause of an insert with the AirportJsonSerializer:
+  //
+  //   {"action": "NOTHING" | "UPDATE",
+  //    "conflict_target": [<column name>, ...],
+  //    "set_columns": [<column name>, ...],
+  //    "set_expressions": [<expression>, ...],
+  //    "do_update_condition": <expression> (only when there is one),
+  //    "column_names_by_index": [<column name>, ...]}
+  //
+  // An empty conflict_target means a conflict with any unique constraint.
+  // The expressions are bound references, the first columns by index are
+  // the row being inserted (named excluded.<column>), followed by the
+  // columns of the existing row that the expressions use.
+  static string AirportSerializeOnConflict(ClientContext &context, LogicalInsert &op)
+  {
+    auto &columns = op.table.GetColumns();
+
+    auto allocator = AirportJSONAllocator(BufferAllocator::Get(context));
+    auto alc = allocator.GetYYAlc();
+
+    auto doc = AirportJSONCommon::CreateDocument(alc);
+    auto result_obj = yyjson_mut_obj(doc);
+    yyjson_mut_doc_set_root(doc, result_obj);
+
+    yyjson_mut_obj_add_strcpy(doc, result_obj, "action", EnumUtil::ToChars(op.action_type));
+
+    vector<column_t> conflict_target(op.on_conflict_filter.begin(), op.on_conflict_filter.end());
+    std::sort(conflict_target.begin(), conflict_target.end());
+    auto conflict_target_arr = yyjson_mut_arr(doc);
+    for (auto column_id : conflict_target)
+    {
+      yyjson_mut_arr_add_strcpy(doc, conflict_target_arr, columns.GetColumn(PhysicalIndex(column_id)).Name().c_str());
+    }
+    yyjson_mut_obj_add_val(doc, result_obj, "conflict_target", conflict_target_arr);
+
+    auto set_columns_arr = yyjson_mut_arr(doc);
+    for (auto &column : op.set_columns)
+    {
+      yyjson_mut_arr_add_strcpy(doc, set_columns_arr, columns.GetColumn(column).Name().c_str());
+    }
+    yyjson_mut_obj_add_val(doc, result_obj, "set_columns", set_columns_arr);
+
+    auto set_expressions_arr = yyjson_mut_arr(doc);
+    for (auto &expr : op.expressions)
+    {
+      auto serializer = AirportJsonSerializer(doc, false, false, false);
+      expr->Serialize(serializer);
+      yyjson_mut_arr_append(set_expressions_arr, serializer.GetRootObject());
+    }
+    yyjson_mut_obj_add_val(doc, result_obj, "set_expressions", set_expressions_arr);
+
+    if (op.do_update_condition)
+    {
+      auto serializer = AirportJsonSerializer(doc, false, false, false);
+      op.do_update_condition->Serialize(serializer);
+      yyjson_mut_obj_add_val(doc, result_obj, "do_update_condition", serializer.GetRootObject());
+    }
+
+    auto column_names_arr = yyjson_mut_arr(doc);
+    for (auto &column : columns.Physical())
+    {
+      yyjson_mut_arr_add_strcpy(doc, column_names_arr, ("excluded." + column.Name()).c_str());
+    }
+    for (auto column_id : op.columns_to_fetch)
+    {
+      yyjson_mut_arr_add_strcpy(doc, column_names_arr, columns.GetColumn(PhysicalIndex(column_id)).Name().c_str());
+    }
+    yyjson_mut_obj_add_val(doc, result_obj, "column_names_by_index", column_names_arr);
+
+    idx_t len;
+    yyjson_write_err write_error;
+    auto data = yyjson_mut_val_write_opts(
+        result_obj,
+        AirportJSONCommon::WRITE_FLAG,
+        alc, reinterpret_cast<size_t *>(&len), &write_error);
+
+    if (data == nullptr)
+    {
+      throw SerializationException(
+          "Failed to serialize json, perhaps the query contains invalid utf8 characters? Error %s",
+          write_error.msg);
+    }
+    return string(data, (size_t)len);
+  }
+
   PhysicalOperator &AirportCatalog::PlanInsert(ClientContext &context,
                                                PhysicalPlanGenerator &planner,
                                                LogicalInsert &op,
                                                optional_ptr<PhysicalOperator> plan)
   {
 
-    if (op.action_type != OnConflictAction::THROW)
+    switch (op.action_type)
     {
-      throw BinderException("ON CONFLICT clause not yet supported for insertion into Airport table");
+    case OnConflictAction::THROW:
+    case OnConflictAction::NOTHING:
+    case OnConflictAction::UPDATE:
+      break;
+    default:
+      throw BinderException("ON CONFLICT %s is not supported for insertion into Airport table",
+                            EnumUtil::ToString(op.action_type));
     }
 
     //    plan = AddCastToAirportTypes(context, std::move(plan));
@@ -459,6 +774,27 @@ namespace duckdb
         op.return_chunk,
         std::move(op.bound_defaults),
         std::move(op.bound_constraints));
+    auto &airport_table = op.table.Cast<AirportTableEntry>();
+    if (op.action_type != OnConflictAction::THROW)
+    {
+      insert.action_type = op.action_type;
+      insert.on_conflict = AirportSerializeOnConflict(context, op);
+      insert.parallel_exchange = AirportExchangeSupportsParallelStreams(context, airport_table);
+    }
+    else if (!op.return_chunk && !context.transaction.IsAutoCommit() &&
+             AirportGetBooleanSetting(context, "airport_write_behind", false))
+    {
+      // Small inserts inside an explicit transaction are held until it
+      // commits, rather than each paying for its own exchange.
+      insert.write_behind = true;
+    }
+    else
+    {
+      string staging_uri;
+      insert.parallel_exchange = AirportExchangeSupportsParallelStreams(context, airport_table) ||
+                                 (!op.return_chunk && (AirportTableSupportsPutIngest(context, airport_table) ||
+                                                       AirportTableSupportsStagedIngest(context, airport_table, staging_uri)));
+    }
 
     if (plan)
     {
@@ -142,7 +142,6 @@ namespace duckdb
     {
       ScalarFunctionSet flight_func_set(pair.first.name);
 
-      // FIXME: need a way to specify the function stability.
       for (const auto &function : pair.second)
       {
         auto input_types = AirportSchemaToLogicalTypes(context, function.input_schema(), function.server_location(), function.descriptor());
@@ -150,6 +149,14 @@ namespace duckdb
         auto output_types = AirportSchemaToLogicalTypes(context, function.schema(), function.server_location(), function.descriptor());
         D_ASSERT(output_types.size() == 1);
 
+        auto function_info = make_uniq<AirportScalarFunctionInfo>(function.name(),
+                                                                  function,
+                                                                  function.schema(),
+                                                                  function.input_schema(),
+                                                                  catalog);
+
+        // Consistent functions can be constant folded, which calls them
+        // once while the query is planned.
         auto scalar_func = ScalarFunction(input_types, output_types[0],
                                           AirportScalarFunctionProcessChunk,
                                           AirportScalarFunctionBind,
@@ -157,14 +164,10 @@ namespace duckdb
                                           nullptr,
                                           AirportScalarFunctionInitLocalState,
                                           LogicalTypeId::INVALID,
-                                          duckdb::FunctionStability::VOLATILE,
+                                          function_info->stability(),
                                           duckdb::FunctionNullHandling::DEFAULT_NULL_HANDLING,
                                           nullptr);
-        scalar_func.function_info = make_uniq<AirportScalarFunctionInfo>(function.name(),
-                                                                         function,
-                                                                         function.schema(),
-                                                                         function.input_schema(),
-                                                                         catalog);
+        scalar_func.function_info = std::move(function_info);
 
         flight_func_set.AddFunction(scalar_func);
       }
@@ -199,6 +199,16 @@ namespace duckdb
     return GetCatalogSet(lookup_info.GetCatalogType()).GetEntry(transaction.GetContext(), lookup_info);
   }
 
+  optional_ptr<AirportTableEntry> AirportSchemaEntry::LookupTable(ClientContext &context, const string &name)
+  {
+    auto entry = tables.GetEntry(context, EntryLookupInfo(CatalogType::TABLE_ENTRY, name));
+    if (!entry || entry->type != CatalogType::TABLE_ENTRY)
+    {
+      return nullptr;
+    }
+    return &entry->Cast<AirportTableEntry>();
+  }
+
   AirportCatalogSet &AirportSchemaEntry::GetCatalogSet(CatalogType type)
   {
     switch (type)
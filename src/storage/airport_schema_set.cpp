@@ -73,7 +73,7 @@ namespace duckdb
     // airport_catalog.internal_name() is the name of the database as passed ot attach.
     auto returned_collection = AirportAPI::GetSchemas(airport_catalog.internal_name(), airport_catalog.attach_parameters());
 
-    airport_catalog.loaded_catalog_version = returned_collection->version_info;
+    airport_catalog.set_loaded_catalog_version(returned_collection->version_info);
 
     collection = std::move(returned_collection);
 
@@ -155,7 +155,7 @@ namespace duckdb
 
     call_options.headers.emplace_back("airport-action-name", "create_schema");
 
-    auto flight_client = AirportAPI::FlightClientForLocation(airport_catalog.attach_parameters()->location());
+    auto flight_client = AirportAPI::FlightClientForLocation(*airport_catalog.attach_parameters());
 
     AirportCreateSchemaParameters params;
     params.catalog_name = airport_catalog.internal_name();
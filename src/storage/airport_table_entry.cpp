@@ -48,7 +48,7 @@ namespace duckdb
     airport_add_authorization_header(call_options, airport_catalog.attach_parameters()->auth_token());
 
     auto &server_location = airport_catalog.attach_parameters()->location();
-    auto flight_client = AirportAPI::FlightClientForLocation(airport_catalog.attach_parameters()->location());
+    auto flight_client = AirportAPI::FlightClientForLocation(*airport_catalog.attach_parameters());
 
     // if (alter.type == AlterType::SET_COLUMN_COMMENT)
     // {
@@ -31,6 +31,7 @@
 #include "airport_macros.hpp"
 #include "airport_scalar_function.hpp"
 #include "airport_secrets.hpp"
+#include "airport_settings.hpp"
 #include "airport_take_flight.hpp"
 #include "storage/airport_catalog_api.hpp"
 #include "storage/airport_catalog.hpp"
@@ -436,7 +437,11 @@ namespace duckdb
     // Indicate if the caller is interested in data being returned.
     call_options.headers.emplace_back("return-chunks", "1");
 
-    auto flight_client = AirportAPI::FlightClientForLocation(bind_data.server_location());
+    AirportUseMemoryPool(context, call_options);
+
+    AirportUseIpcCompression(context, call_options);
+
+    auto flight_client = AirportTakeFlightClient(context, bind_data.take_flight_params(), bind_data.table_entry());
 
     AIRPORT_ASSIGN_OR_RAISE_CONTAINER(
         auto exchange_result,
@@ -478,7 +483,7 @@ namespace duckdb
 
     // Tell the server the schema that we will be using to write data.
     AIRPORT_ARROW_ASSERT_OK_CONTAINER(
-        exchange_result.writer->Begin(send_schema),
+        exchange_result.writer->Begin(send_schema, call_options.write_options),
         &bind_data,
         "airport_dynamic_table_function: send schema");
 
@@ -566,6 +571,11 @@ namespace duckdb
     auto &global_state = data_p.global_state->Cast<AirportDynamicTableInOutGlobalState>();
     lock_guard<mutex> l(global_state.lock);
 
+    // Unlike DML this doesn't collect chunks in an AirportExchangeWriteBuffer.
+    // The server answers every batch with exactly one batch, and the answer
+    // is read right here before returning, so the input has to be written
+    // as it arrives. Holding it back would leave this waiting on a reply to
+    // a batch that was never sent.
     auto appender = make_uniq<ArrowAppender>(
         input.GetTypes(),
         input.size(),
@@ -405,7 +405,7 @@ namespace duckdb
 
     call_options.headers.emplace_back("airport-action-name", "create_table");
 
-    auto flight_client = AirportAPI::FlightClientForLocation(airport_catalog.attach_parameters()->location());
+    auto flight_client = AirportAPI::FlightClientForLocation(*airport_catalog.attach_parameters());
 
     AIRPORT_MSGPACK_ACTION_SINGLE_PARAMETER(action, "create_table", params);
 
@@ -498,7 +498,7 @@ namespace duckdb
 
     call_options.headers.emplace_back("airport-action-name", "flight_info");
 
-    auto flight_client = AirportAPI::FlightClientForLocation(airport_catalog.attach_parameters()->location());
+    auto flight_client = AirportAPI::FlightClientForLocation(*airport_catalog.attach_parameters());
 
     AIRPORT_MSGPACK_ACTION_SINGLE_PARAMETER(action, "flight_info", params);
 
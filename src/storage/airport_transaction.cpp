@@ -6,6 +6,9 @@
 #include "duckdb/catalog/catalog_entry/view_catalog_entry.hpp"
 #include "airport_request_headers.hpp"
 #include "airport_macros.hpp"
+#include "airport_settings.hpp"
+#include "storage/airport_insert.hpp"
+#include "storage/airport_table_entry.hpp"
 #include <arrow/flight/client.h>
 #include <arrow/flight/types.h>
 #include <arrow/buffer.h>
@@ -35,10 +38,10 @@ namespace duckdb
     MSGPACK_DEFINE_MAP(catalog_name)
   };
 
-  std::optional<string> AirportTransaction::GetTransactionIdentifier()
+  std::optional<string> AirportTransaction::GetTransactionIdentifier() const
   {
     auto &server_location = attach_parameters->location();
-    auto flight_client = AirportAPI::FlightClientForLocation(attach_parameters->location());
+    auto flight_client = AirportAPI::FlightClientForLocation(*attach_parameters);
 
     arrow::flight::FlightCallOptions call_options;
     airport_add_standard_headers(call_options, attach_parameters->location());
@@ -70,15 +73,35 @@ namespace duckdb
     return result.identifier;
   }
 
+  const std::optional<std::string> &AirportTransaction::identifier() const
+  {
+    lock_guard<mutex> identifier_guard(identifier_lock_);
+    if (identifier_requested_)
+    {
+      return identifier_;
+    }
+
+    // Servers can declare in the catalog version that they don't use
+    // transactions, so there is no need to ask for an identifier.
+    auto &airport_catalog = manager.GetDB().GetCatalog().Cast<AirportCatalog>();
+    const auto catalog_version = airport_catalog.loaded_catalog_version();
+    if (!catalog_version.has_value() || catalog_version->uses_transactions.value_or(true))
+    {
+      // Get an identifier from the server that will be passed as airport-transaction-id
+      // in requests.
+      identifier_ = GetTransactionIdentifier();
+    }
+    identifier_requested_ = true;
+    return identifier_;
+  }
+
   void AirportTransaction::Start()
   {
     transaction_state = AirportTransactionState::TRANSACTION_NOT_YET_STARTED;
-    // Get an identifier from the server that will be passed as airport-transaction-id
-    // in requests.
-    identifier_ = GetTransactionIdentifier();
   }
-  void AirportTransaction::Commit()
+  void AirportTransaction::Commit(ClientContext &context)
   {
+    FlushBufferedInserts(context);
     if (transaction_state == AirportTransactionState::TRANSACTION_STARTED)
     {
       transaction_state = AirportTransactionState::TRANSACTION_FINISHED;
@@ -86,12 +109,100 @@ namespace duckdb
   }
   void AirportTransaction::Rollback()
   {
+    {
+      // Nothing was sent, so there is nothing to undo.
+      lock_guard<mutex> buffered_inserts_guard(buffered_inserts_lock_);
+      buffered_inserts_.clear();
+    }
     if (transaction_state == AirportTransactionState::TRANSACTION_STARTED)
     {
       transaction_state = AirportTransactionState::TRANSACTION_FINISHED;
     }
   }
 
+  bool AirportTransaction::BufferedInserts::IsFor(const AirportTableEntry &table) const
+  {
+    return table.schema.name == schema_name && table.name == table_name;
+  }
+
+  idx_t AirportTransaction::BufferInsert(ClientContext &context, AirportTableEntry &table, DataChunk &chunk)
+  {
+    bool flush = false;
+    {
+      lock_guard<mutex> buffered_inserts_guard(buffered_inserts_lock_);
+      optional_ptr<BufferedInserts> entry;
+      for (auto &buffered : buffered_inserts_)
+      {
+        if (buffered.IsFor(table))
+        {
+          entry = &buffered;
+          break;
+        }
+      }
+      if (!entry)
+      {
+        vector<string> column_names;
+        for (auto &column : table.GetColumns().Logical())
+        {
+          column_names.push_back(column.GetName());
+        }
+        buffered_inserts_.push_back({table.schema.name,
+                                     table.name,
+                                     std::move(column_names),
+                                     make_uniq<ColumnDataCollection>(context, chunk.GetTypes())});
+        entry = &buffered_inserts_.back();
+      }
+      entry->rows->Append(chunk);
+      flush = entry->rows->Count() >= AirportWriteBatchRows(context) ||
+              entry->rows->SizeInBytes() >= AirportWriteBatchBytes(context);
+    }
+    if (flush)
+    {
+      FlushBufferedInserts(context, &table);
+    }
+    return chunk.size();
+  }
+
+  void AirportTransaction::FlushBufferedInserts(ClientContext &context, optional_ptr<const AirportTableEntry> table)
+  {
+    vector<BufferedInserts> to_send;
+    {
+      lock_guard<mutex> buffered_inserts_guard(buffered_inserts_lock_);
+      for (auto it = buffered_inserts_.begin(); it != buffered_inserts_.end();)
+      {
+        if (!table || it->IsFor(*table))
+        {
+          to_send.push_back(std::move(*it));
+          it = buffered_inserts_.erase(it);
+        }
+        else
+        {
+          ++it;
+        }
+      }
+    }
+
+    auto &airport_catalog = manager.GetDB().GetCatalog().Cast<AirportCatalog>();
+    for (auto &buffered : to_send)
+    {
+      // Send the rows to the table as it is now, as long as it still has
+      // the columns they were inserted with.
+      auto current = airport_catalog.LookupTable(context, buffered.schema_name, buffered.table_name);
+      bool matches = current && current->GetColumns().LogicalColumnCount() == buffered.column_names.size();
+      for (idx_t i = 0; matches && i < buffered.column_names.size(); i++)
+      {
+        auto &column = current->GetColumns().GetColumn(LogicalIndex(i));
+        matches = column.GetName() == buffered.column_names[i] && column.GetType() == buffered.rows->Types()[i];
+      }
+      if (!matches)
+      {
+        throw TransactionException("Table \"%s.%s\" was dropped or altered before the %llu rows inserted into it in this transaction were sent",
+                                   buffered.schema_name, buffered.table_name, buffered.rows->Count());
+      }
+      AirportInsertBufferedRows(context, *current, *buffered.rows, identifier());
+    }
+  }
+
   AirportTransaction &AirportTransaction::Get(ClientContext &context, Catalog &catalog)
   {
     return Transaction::Get(context, catalog).Cast<AirportTransaction>();
@@ -23,10 +23,19 @@ namespace duckdb
   ErrorData AirportTransactionManager::CommitTransaction(ClientContext &context, Transaction &transaction)
   {
     auto &airport_transaction = transaction.Cast<AirportTransaction>();
-    airport_transaction.Commit();
+    ErrorData error;
+    try
+    {
+      airport_transaction.Commit(context);
+    }
+    catch (std::exception &ex)
+    {
+      // The buffered inserts couldn't be sent.
+      error = ErrorData(ex);
+    }
     lock_guard<mutex> l(transaction_lock);
     transactions.erase(transaction);
-    return ErrorData();
+    return error;
   }
 
   void AirportTransactionManager::RollbackTransaction(Transaction &transaction)
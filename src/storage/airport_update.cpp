@@ -94,6 +94,10 @@ namespace duckdb
     mutex update_lock;
     idx_t update_count;
 
+    // The returned rows are added by the reader threads of the exchanges,
+    // this doesn't use update_lock since a writer can hold that while it
+    // waits for the server to accept a batch.
+    mutex return_lock;
     ColumnDataCollection return_collection;
 
     const bool return_chunk;
@@ -105,7 +109,6 @@ namespace duckdb
     AirportUpdateLocalState(ClientContext &context,
                             const TableCatalogEntry &table,
                             const vector<unique_ptr<Expression>> &expressions,
-                            const vector<LogicalType> &table_types,
                             const vector<unique_ptr<Expression>> &bound_defaults,
                             const vector<unique_ptr<BoundConstraint>> &bound_constraints,
                             const vector<LogicalType> &update_types)
@@ -114,41 +117,76 @@ namespace duckdb
     {
       auto &allocator = Allocator::Get(context);
       D_ASSERT(update_types.size() == expressions.size() + 1);
-      read_from_flight_chunk.Initialize(allocator, update_types);
-      table_mock_chunk.Initialize(allocator, table_types);
+      send_update_chunk.Initialize(allocator, update_types);
     }
 
     // This is the DataChunk that has the type of the update that will
-    // be returned from the external service.
-    DataChunk read_from_flight_chunk;
-
-    // This is the DataChunk that has the types of the table and in
-    // the order of the columns of the table
-    DataChunk table_mock_chunk;
+    // be sent to the external service.
+    DataChunk send_update_chunk;
 
     ExpressionExecutor default_executor;
     const vector<unique_ptr<BoundConstraint>> &bound_constraints;
+
+    // The stream of this thread, only used when the table supports
+    // parallel exchanges.
+    unique_ptr<AirportExchangeGlobalState> exchange;
+
+    // The updated rows waiting to be sent.
+    unique_ptr<AirportExchangeWriteBuffer> write_buffer;
   };
 
-  unique_ptr<GlobalSinkState> AirportUpdate::GetGlobalSinkState(ClientContext &context) const
+  // The updated rows are read from the exchange while updates are still
+  // being written to it. The server returns the rows with the same columns
+  // that are sent, so they are placed in a chunk that has the types of the
+  // table.
+  static void AirportUpdateReadReturnedRows(ClientContext &context,
+                                            AirportUpdateGlobalState &gstate,
+                                            AirportExchangeGlobalState &exchange,
+                                            const vector<PhysicalIndex> &columns)
   {
-    auto &airport_table = this->table.Cast<AirportTableEntry>();
+    auto table_mock_chunk = make_shared_ptr<DataChunk>();
+    table_mock_chunk->Initialize(Allocator::Get(context), gstate.table.GetTypes());
 
-    auto update_global_state = make_uniq<AirportUpdateGlobalState>(
-        context,
-        airport_table,
-        GetTypes(),
-        return_chunk);
+    exchange.return_reader = make_uniq<AirportExchangeReturnReader>(
+        context, exchange, exchange.send_types,
+        [&gstate, &columns, table_mock_chunk](DataChunk &returned)
+        {
+          auto &mock_chunk = *table_mock_chunk;
+          mock_chunk.Reset();
+          mock_chunk.SetCardinality(returned.size());
+          for (idx_t i = 0; i < columns.size(); i++)
+          {
+            mock_chunk.data[columns[i].index].Reference(returned.data[i]);
+          }
+          mock_chunk.Verify();
+
+          lock_guard<mutex> return_guard(gstate.return_lock);
+          gstate.return_collection.Append(mock_chunk);
+        });
+  }
 
+  static void AirportUpdateFlush(AirportUpdateGlobalState &gstate, AirportUpdateLocalState &lstate)
+  {
+    if (lstate.exchange)
+    {
+      lstate.write_buffer->Flush(gstate.table, *lstate.exchange);
+      return;
+    }
+    lock_guard<mutex> update_guard(gstate.update_lock);
+    lstate.write_buffer->Flush(gstate.table, gstate);
+  }
+
+  void AirportUpdate::OpenExchange(ClientContext &context, AirportTableEntry &airport_table, AirportExchangeGlobalState &exchange) const
+  {
     auto &transaction = AirportTransaction::Get(context, table.catalog);
 
-    update_global_state->send_types = send_types;
+    exchange.send_types = send_types;
 
     ArrowSchema send_schema;
     auto client_properties = context.GetClientProperties();
 
     ArrowConverter::ToArrowSchema(&send_schema,
-                                  update_global_state->send_types,
+                                  exchange.send_types,
                                   send_names,
                                   client_properties);
 
@@ -164,12 +202,34 @@ namespace duckdb
     AirportExchangeGetGlobalSinkState(context,
                                       table,
                                       airport_table,
-                                      update_global_state.get(),
+                                      &exchange,
                                       send_schema,
                                       return_chunk,
                                       "update",
                                       table_column_names,
                                       transaction.identifier());
+  }
+
+  unique_ptr<GlobalSinkState> AirportUpdate::GetGlobalSinkState(ClientContext &context) const
+  {
+    auto &airport_table = this->table.Cast<AirportTableEntry>();
+
+    auto update_global_state = make_uniq<AirportUpdateGlobalState>(
+        context,
+        airport_table,
+        GetTypes(),
+        return_chunk);
+
+    // With parallel exchanges each thread opens its own stream when it
+    // gets its first chunk.
+    if (!parallel_exchange)
+    {
+      OpenExchange(context, airport_table, *update_global_state);
+      if (return_chunk)
+      {
+        AirportUpdateReadReturnedRows(context, *update_global_state, *update_global_state, columns);
+      }
+    }
 
     return update_global_state;
   }
@@ -179,7 +239,6 @@ namespace duckdb
     return make_uniq<AirportUpdateLocalState>(context.client,
                                               table,
                                               expressions,
-                                              table.GetTypes(),
                                               bound_defaults,
                                               bound_constraints,
                                               send_types);
@@ -193,7 +252,7 @@ namespace duckdb
     auto &gstate = input.global_state.Cast<AirportUpdateGlobalState>();
     auto &lstate = input.local_state.Cast<AirportUpdateLocalState>();
 
-    DataChunk &send_update_chunk = lstate.read_from_flight_chunk;
+    DataChunk &send_update_chunk = lstate.send_update_chunk;
 
     chunk.Flatten();
     lstate.default_executor.SetChunk(chunk);
@@ -223,75 +282,27 @@ namespace duckdb
 
     send_update_chunk.data[expressions.size()].Reference(chunk.data[chunk.ColumnCount() - 1]);
 
-    lock_guard<mutex> update_guard(gstate.update_lock);
-    // Acquire a lock because we don't want other threads to be writing to the same streams
-    // at the same time.
-
-    auto appender = make_uniq<ArrowAppender>(gstate.send_types, send_update_chunk.size(), context.client.GetClientProperties(),
-                                             ArrowTypeExtensionData::GetExtensionTypes(
-                                                 context.client, gstate.send_types));
-    appender->Append(send_update_chunk, 0, send_update_chunk.size(), send_update_chunk.size());
-    ArrowArray arr = appender->Finalize();
-
-    // Import the record batch into the the C++ side of Arrow and write it
-    // to the stream.
-
-    AIRPORT_ASSIGN_OR_RAISE_CONTAINER(
-        auto record_batch,
-        arrow::ImportRecordBatch(&arr, gstate.send_schema),
-        gstate.table.table_data, "");
-
-    AIRPORT_ARROW_ASSERT_OK_CONTAINER(
-        gstate.writer->WriteRecordBatch(*record_batch),
-        gstate.table.table_data, "");
-
-    // Since we wrote a batch I'd like to read the data returned if we are returning chunks.
-    if (gstate.return_chunk)
+    if (parallel_exchange && !lstate.exchange)
     {
-      // printf("Returning data\n");
-      lstate.read_from_flight_chunk.Reset();
-
+      lstate.exchange = make_uniq<AirportExchangeGlobalState>();
+      OpenExchange(context.client, gstate.table, *lstate.exchange);
+      if (return_chunk)
       {
-        auto &data = gstate.scan_table_function_input->bind_data->CastNoConst<AirportExchangeTakeFlightBindData>();
-        auto &state = gstate.scan_table_function_input->local_state->Cast<AirportArrowScanLocalState>();
-        //        auto &global_state = gstate.scan_table_function_input->global_state->Cast<AirportArrowScanGlobalState>();
-
-        state.Reset();
-        state.chunk = state.stream()->GetNextChunk();
-
-        auto output_size =
-            MinValue<idx_t>(STANDARD_VECTOR_SIZE, NumericCast<idx_t>(state.chunk->arrow_array.length) - state.chunk_offset);
-        state.lines_read += output_size;
-
-        // printf("Returning chunk is:\n%s\n", lstate.read_from_flight_chunk.ToString().c_str());
-
-        lstate.read_from_flight_chunk.SetCardinality(state.chunk->arrow_array.length);
-
-        ArrowTableFunction::ArrowToDuckDB(state,
-                                          // The arrow arrow_table has the columns
-                                          // which are the types of the update.
-                                          data.arrow_table.GetColumns(),
-                                          lstate.read_from_flight_chunk,
-                                          state.lines_read - output_size,
-                                          false);
-        lstate.read_from_flight_chunk.Verify();
-        DataChunk &mock_chunk = lstate.table_mock_chunk;
-
-        mock_chunk.SetCardinality(state.chunk->arrow_array.length);
-        for (idx_t i = 0; i < columns.size(); i++)
-        {
-          mock_chunk.data[columns[i].index].Reference(lstate.read_from_flight_chunk.data[i]);
-        }
-
-        lstate.table_mock_chunk.Verify();
-
-        // printf("Read chunk to return:%s\n", mock_chunk.ToString().c_str());
-
-        // Now the problem is the rowid column is being returned from the remote server
-
-        gstate.return_collection.Append(mock_chunk);
+        AirportUpdateReadReturnedRows(context.client, gstate, *lstate.exchange, columns);
       }
     }
+    AirportExchangeGlobalState &exchange = lstate.exchange ? *lstate.exchange : gstate;
+
+    // The updated rows (if they are returned) are read on another thread,
+    // so the rows can be sent in larger batches.
+    if (!lstate.write_buffer)
+    {
+      lstate.write_buffer = make_uniq<AirportExchangeWriteBuffer>(context.client, exchange.send_types);
+    }
+    if (lstate.write_buffer->Append(send_update_chunk))
+    {
+      AirportUpdateFlush(gstate, lstate);
+    }
 
     return SinkResultType::NEED_MORE_INPUT;
   }
@@ -302,37 +313,60 @@ namespace duckdb
     MSGPACK_DEFINE_MAP(total_updated)
   };
 
+  static idx_t AirportUpdateFinishExchange(AirportTableEntry &table, AirportExchangeGlobalState &exchange)
+  {
+    auto last_app_metadata = AirportExchangeFinish(table, exchange);
+    if (!last_app_metadata)
+    {
+      return 0;
+    }
+
+    AIRPORT_MSGPACK_UNPACK(AirportUpdateFinalMetadata, final_metadata,
+                           (*last_app_metadata),
+                           table.table_data->server_location(),
+                           "Failed to parse msgpack encoded object for final update metadata.");
+    return final_metadata.total_updated;
+  }
+
   //===--------------------------------------------------------------------===//
-  // Finalize
+  // Combine
   //===--------------------------------------------------------------------===//
-  SinkFinalizeType AirportUpdate::Finalize(Pipeline &pipeline, Event &event, ClientContext &context,
-                                           OperatorSinkFinalizeInput &input) const
+  SinkCombineResultType AirportUpdate::Combine(ExecutionContext &context, OperatorSinkCombineInput &input) const
   {
     auto &gstate = input.global_state.Cast<AirportUpdateGlobalState>();
+    auto &lstate = input.local_state.Cast<AirportUpdateLocalState>();
 
-    AIRPORT_ARROW_ASSERT_OK_CONTAINER(
-        gstate.writer->DoneWriting(),
-        gstate.table.table_data, "");
+    if (lstate.write_buffer)
+    {
+      AirportUpdateFlush(gstate, lstate);
+    }
 
+    if (!lstate.exchange)
     {
-      auto &bind_data = gstate.scan_table_function_input->bind_data->CastNoConst<AirportExchangeTakeFlightBindData>();
-      auto &state = gstate.scan_table_function_input->local_state->Cast<AirportArrowScanLocalState>();
-      //      auto &global_state = gstate.scan_table_function_input->global_state->Cast<AirportArrowScanGlobalState>();
+      return SinkCombineResultType::FINISHED;
+    }
 
-      state.Reset();
+    // Each stream reports the number of rows it updated.
+    auto updated = AirportUpdateFinishExchange(gstate.table, *lstate.exchange);
+    lstate.exchange.reset();
 
-      state.chunk = state.stream()->GetNextChunk();
+    lock_guard<mutex> update_guard(gstate.update_lock);
+    gstate.update_count += updated;
 
-      auto &last_app_metadata = bind_data.last_app_metadata;
+    return SinkCombineResultType::FINISHED;
+  }
 
-      if (last_app_metadata)
-      {
-        AIRPORT_MSGPACK_UNPACK(AirportUpdateFinalMetadata, final_metadata,
-                               (*last_app_metadata),
-                               gstate.table.table_data->server_location(),
-                               "Failed to parse msgpack encoded object for final update metadata.");
-        gstate.update_count = final_metadata.total_updated;
-      }
+  //===--------------------------------------------------------------------===//
+  // Finalize
+  //===--------------------------------------------------------------------===//
+  SinkFinalizeType AirportUpdate::Finalize(Pipeline &pipeline, Event &event, ClientContext &context,
+                                           OperatorSinkFinalizeInput &input) const
+  {
+    auto &gstate = input.global_state.Cast<AirportUpdateGlobalState>();
+
+    if (!parallel_exchange)
+    {
+      gstate.update_count = AirportUpdateFinishExchange(gstate.table, gstate);
     }
 
     return SinkFinalizeType::READY;
@@ -396,6 +430,10 @@ namespace duckdb
   {
     InsertionOrderPreservingMap<string> result;
     result["Table Name"] = table.name;
+    if (parallel_exchange)
+    {
+      result["Parallel Exchange"] = "true";
+    }
     return result;
   }
 
@@ -422,7 +460,7 @@ namespace duckdb
         throw BinderException("RETURNING clause not yet supported for parameterized update of an Airport table");
       }
 
-      auto &upd = planner.Make<AirportUpdateParameterized>(op, op.table, plan);
+      auto &upd = planner.Make<AirportUpdateParameterized>(context, op, op.table, plan);
       upd.children.push_back(plan);
       return upd;
     }
@@ -436,6 +474,7 @@ namespace duckdb
                                                op.estimated_cardinality,
                                                op.return_chunk,
                                                op.update_is_del_and_insert);
+    update.parallel_exchange = AirportExchangeSupportsParallelStreams(context, airport_table);
 
     update.children.push_back(plan);
     return update;
@@ -20,95 +20,118 @@
 #include "airport_flight_stream.hpp"
 #include "airport_take_flight.hpp"
 #include "storage/airport_exchange.hpp"
-#include "duckdb/execution/operator/filter/physical_filter.hpp"
+#include "airport_json_common.hpp"
+#include "airport_json_serializer.hpp"
+#include "msgpack.hpp"
 #include "duckdb/execution/operator/scan/physical_table_scan.hpp"
 #include "duckdb/execution/operator/projection/physical_projection.hpp"
 
 namespace duckdb
 {
 
-  static string ExtractFilters(PhysicalOperator &child, const string &statement)
+  // The names of the columns produced by the scan, the SET expressions
+  // refer to these by index.
+  static vector<string> AirportScanOutputNames(const PhysicalTableScan &table_scan)
   {
-    // Check for FILTER operator type
-    if (child.type == PhysicalOperatorType::FILTER)
+    auto column_name = [&](const ColumnIndex &id)
     {
-      auto &filter = child.Cast<PhysicalFilter>();
-      string result = ExtractFilters(child.children[0], statement);
-      return result.empty() ? filter.expression->ToString() : result + " AND " + filter.expression->ToString();
-    }
+      return id.IsRowIdColumn() ? string("rowid") : table_scan.names[id.GetPrimaryIndex()];
+    };
 
-    // Check for TABLE_SCAN operator type
-    if (child.type == PhysicalOperatorType::TABLE_SCAN)
+    vector<string> result;
+    if (table_scan.projection_ids.empty())
     {
-      const auto &table_scan = child.Cast<PhysicalTableScan>();
-      if (!table_scan.table_filters)
+      for (auto &id : table_scan.column_ids)
       {
-        return {};
+        result.push_back(column_name(id));
       }
-      throw NotImplementedException("Pushed down table filters not supported currently");
     }
-
-    if (child.type == PhysicalOperatorType::PROJECTION)
+    else
     {
-      //      auto &proj = child.Cast<PhysicalProjection>();
-      return ExtractFilters(child.children[0], statement);
+      for (auto projection_id : table_scan.projection_ids)
+      {
+        result.push_back(column_name(table_scan.column_ids[projection_id]));
+      }
     }
-
-    // Handle unsupported operator types
-    throw NotImplementedException(
-        "Unsupported operator type %s in %s statement - only simple expressions "
-        "(e.g. %s FROM tbl WHERE x=y) are supported in AirportParameterizedUpdate",
-        PhysicalOperatorToString(child.type), statement, statement);
+    return result;
   }
 
-  static std::pair<string, string> ConstructUpdateStatement(LogicalUpdate &op, PhysicalOperator &child)
+  // Serialize the SET expressions of the update with the AirportJsonSerializer:
+  //
+  //   {"columns": [<column name>, ...], "expressions": [<expression>, ...],
+  //    "column_names_by_index": [<column name>, ...]}
+  //
+  // The expressions are bound references to the columns of the scan, their
+  // index is the position in column_names_by_index.
+  static string AirportSerializeUpdateExpressions(ClientContext &context, LogicalUpdate &op, PhysicalOperator &child)
   {
     if (child.type != PhysicalOperatorType::PROJECTION)
     {
       throw NotImplementedException(
           "Airport Parameterized Update not supported - Expected the child of an update to be a projection");
     }
-
     auto &proj = child.Cast<PhysicalProjection>();
-    string expressions;
 
+    bool has_filter = false;
+    auto &table_scan = AirportParameterizedScan(child, "UPDATE", has_filter);
+
+    auto allocator = AirportJSONAllocator(BufferAllocator::Get(context));
+    auto alc = allocator.GetYYAlc();
+
+    auto doc = AirportJSONCommon::CreateDocument(alc);
+    auto result_obj = yyjson_mut_obj(doc);
+    yyjson_mut_doc_set_root(doc, result_obj);
+
+    auto columns_arr = yyjson_mut_arr(doc);
+    auto expressions_arr = yyjson_mut_arr(doc);
     for (idx_t c = 0; c < op.columns.size(); ++c)
     {
-      if (c > 0)
-      {
-        expressions += ", ";
-      }
-
       const auto &col = op.table.GetColumn(op.table.GetColumns().PhysicalToLogical(op.columns[c]));
-      expressions += col.GetName() + " = ";
+      yyjson_mut_arr_add_strcpy(doc, columns_arr, col.GetName().c_str());
 
-      switch (op.expressions[c]->type)
-      {
-      case ExpressionType::VALUE_DEFAULT:
-        expressions += "DEFAULT";
-        break;
-      case ExpressionType::BOUND_REF:
+      if (op.expressions[c]->type != ExpressionType::BOUND_REF)
       {
-        const auto &ref = op.expressions[c]->Cast<BoundReferenceExpression>();
-        expressions += proj.select_list[ref.index]->ToString();
-        break;
-      }
-      default:
         throw NotImplementedException(
             "Airport Parameterized Update not supported - Expected a bound reference expression");
       }
+      const auto &ref = op.expressions[c]->Cast<BoundReferenceExpression>();
+
+      auto serializer = AirportJsonSerializer(doc, false, false, false);
+      proj.select_list[ref.index]->Serialize(serializer);
+      yyjson_mut_arr_append(expressions_arr, serializer.GetRootObject());
+    }
+
+    auto column_names_arr = yyjson_mut_arr(doc);
+    for (auto &name : AirportScanOutputNames(table_scan))
+    {
+      yyjson_mut_arr_add_strcpy(doc, column_names_arr, name.c_str());
     }
 
-    auto filters = ExtractFilters(child.children[0], "UPDATE");
-    return {expressions, filters};
+    yyjson_mut_obj_add_val(doc, result_obj, "columns", columns_arr);
+    yyjson_mut_obj_add_val(doc, result_obj, "expressions", expressions_arr);
+    yyjson_mut_obj_add_val(doc, result_obj, "column_names_by_index", column_names_arr);
+
+    idx_t len;
+    yyjson_write_err write_error;
+    auto data = yyjson_mut_val_write_opts(
+        result_obj,
+        AirportJSONCommon::WRITE_FLAG,
+        alc, reinterpret_cast<size_t *>(&len), &write_error);
+
+    if (data == nullptr)
+    {
+      throw SerializationException(
+          "Failed to serialize json, perhaps the query contains invalid utf8 characters? Error %s",
+          write_error.msg);
+    }
+    return string(data, (size_t)len);
   }
 
-  AirportUpdateParameterized::AirportUpdateParameterized(PhysicalPlan &physical_plan, LogicalOperator &op, TableCatalogEntry &table, PhysicalOperator &plan)
-      : PhysicalOperator(physical_plan, PhysicalOperatorType::EXTENSION, op.types, 1), table(table)
+  AirportUpdateParameterized::AirportUpdateParameterized(PhysicalPlan &physical_plan, ClientContext &context, LogicalOperator &op, TableCatalogEntry &table, PhysicalOperator &plan)
+      : PhysicalOperator(physical_plan, PhysicalOperatorType::EXTENSION, op.types, 1), table(table),
+        json_filters(AirportParameterizedFilters(plan, "UPDATE")),
+        json_expressions(AirportSerializeUpdateExpressions(context, op.Cast<LogicalUpdate>(), plan))
   {
-    auto result = ConstructUpdateStatement(op.Cast<LogicalUpdate>(), plan);
-    printf("Got expressions: %s\n", result.first.c_str());
-    printf("Got filters: %s\n", result.second.c_str());
   }
 
   //===--------------------------------------------------------------------===//
@@ -126,7 +149,6 @@ namespace duckdb
 
   unique_ptr<GlobalSinkState> AirportUpdateParameterized::GetGlobalSinkState(ClientContext &context) const
   {
-    printf("AirportUpdateParameterized::GetGlobalSinkState\n");
     return make_uniq<AirportUpdateParameterizedGlobalState>();
   }
 
@@ -135,23 +157,37 @@ namespace duckdb
   //===--------------------------------------------------------------------===//
   SinkResultType AirportUpdateParameterized::Sink(ExecutionContext &context, DataChunk &chunk, OperatorSinkInput &input) const
   {
-    printf("AirportUpdateParameterized::Sink\n");
-    return SinkResultType::FINISHED;
+    // The scan is told not to produce any rows, the server does all of
+    // the work in Finalize.
+    return SinkResultType::NEED_MORE_INPUT;
   }
 
   //===--------------------------------------------------------------------===//
   // Finalize
   //===--------------------------------------------------------------------===//
+  struct AirportUpdateParameterizedFinalMetadata
+  {
+    uint64_t total_updated;
+    MSGPACK_DEFINE_MAP(total_updated)
+  };
+
   SinkFinalizeType AirportUpdateParameterized::Finalize(Pipeline &pipeline, Event &event, ClientContext &context,
                                                         OperatorSinkFinalizeInput &input) const
   {
     auto &gstate = input.global_state.Cast<AirportUpdateParameterizedGlobalState>();
+    auto &airport_table = table.Cast<AirportTableEntry>();
+    auto &transaction = AirportTransaction::Get(context, table.catalog);
+
+    auto result = AirportParameterizedDML(context, airport_table, "update", json_filters, json_expressions, transaction.identifier());
     gstate.affected_rows = 0;
-    // auto &transaction = MySQLTransaction::Get(context, table.catalog);
-    // auto &connection = transaction.GetConnection();
-    // auto result = connection.Query(query);
-    // gstate.affected_rows = result->AffectedRows();
-    printf("AirportUpdateParameterized::Finalize\n");
+    if (result)
+    {
+      AIRPORT_MSGPACK_UNPACK(AirportUpdateParameterizedFinalMetadata, final_metadata,
+                             (*result),
+                             airport_table.table_data->server_location(),
+                             "Failed to parse msgpack encoded object for parameterized update result.");
+      gstate.affected_rows = final_metadata.total_updated;
+    }
     return SinkFinalizeType::READY;
   }
 
@@ -161,10 +197,9 @@ namespace duckdb
   SourceResultType AirportUpdateParameterized::GetData(ExecutionContext &context, DataChunk &chunk,
                                                        OperatorSourceInput &input) const
   {
-    auto &insert_gstate = sink_state->Cast<AirportUpdateParameterizedGlobalState>();
+    auto &gstate = sink_state->Cast<AirportUpdateParameterizedGlobalState>();
     chunk.SetCardinality(1);
-    chunk.SetValue(0, 0, Value::BIGINT(insert_gstate.affected_rows));
-    printf("AirportUpdateParameterized::GetData\n");
+    chunk.SetValue(0, 0, Value::BIGINT(gstate.affected_rows));
     return SourceResultType::FINISHED;
   }
 
@@ -180,6 +215,7 @@ namespace duckdb
   {
     InsertionOrderPreservingMap<string> result;
     result["Table Name"] = table.name;
+    result["Filters"] = json_filters.empty() ? "none" : "pushed down";
     return result;
   }
 